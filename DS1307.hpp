@@ -6,6 +6,8 @@
 #ifndef DS1307_HPP
 #define DS1307_HPP
 #include <hwlib.hpp>
+#include "stationLog.hpp"
+#include "stationTrace.hpp"
 
 /// @file
 
@@ -22,15 +24,16 @@ protected:
     /// @detail
     /// All the registers have there right address.
     hwlib::i2c_bus_bit_banged_scl_sda & bus; ///@brief Software i2c bus using hwlib.
-    uint_fast8_t adres_secondes = 0x00; ///@brief Register address for seconds.
-    uint_fast8_t adres_minuten = 0x01; ///@brief Register address for minutes.
-    uint_fast8_t adres_uren = 0x02; /// @brief Register address for hours.
-    uint_fast8_t adres_dagen_week = 0x03; ///@brief Register address for daynames.
-    uint_fast8_t adres_dagen_getal = 0x04; /// @brief Register address for daynumbers.
-    uint_fast8_t adres_maanden = 0x05; ///@brief Register address for months.
-    uint_fast8_t adres_jaren = 0x06; ///@brief Register address for years.
-    uint_fast8_t adres_control = 0x07; /// @brief Register address for controlling the SQW/OUT pin.
-    uint_fast8_t adres = 0x68; ///@brief 7 bit address \details Total write adres is 0xD0 and total read adres is 0xD1
+    const static uint8_t adres_secondes = 0x00; ///@brief Register address for seconds.
+    const static uint8_t adres_minuten = 0x01; ///@brief Register address for minutes.
+    const static uint8_t adres_uren = 0x02; /// @brief Register address for hours.
+    const static uint8_t adres_dagen_week = 0x03; ///@brief Register address for daynames.
+    const static uint8_t adres_dagen_getal = 0x04; /// @brief Register address for daynumbers.
+    const static uint8_t adres_maanden = 0x05; ///@brief Register address for months.
+    const static uint8_t adres_jaren = 0x06; ///@brief Register address for years.
+    const static uint8_t adres_control = 0x07; /// @brief Register address for controlling the SQW/OUT pin.
+    const static uint8_t adres_ram = 0x08; /// @brief First address of the 56 bytes battery backed RAM.
+    const static uint8_t adres = 0x68; ///@brief 7 bit address \details Total write adres is 0xD0 and total read adres is 0xD1
     
     uint8_t secondes;
     uint8_t minuten;
@@ -41,21 +44,6 @@ protected:
     uint8_t maand;
     uint8_t jaren;
     
-    /// \brief   
-    /// Decimal to BCD
-    /// \details
-    /// This function converts decimal integers to the binary-coded decimal (BCD) format
-    uint8_t dec2bcd(uint8_t getal){
-    return ((getal/10 * 16) + (getal % 10));
-}
-
-    /// \brief   
-    /// BCD to decimal
-    /// \details
-    /// This function converts from the binary-coded decimal (BCD) format to decimal integers
-    uint8_t bcd2dec(uint8_t getal){
-    return ((getal/16 * 10) + (getal % 16));
-}
     
     /// \brief   
     /// Read seconds
@@ -158,7 +146,36 @@ protected:
     return bcd2dec(jaren);
 }
 
+    /// \brief   
+    /// Days in month
+    /// \details
+    /// Returns the amount of days in the given month (1 to 12) of the given year (0 to 99, add 1952 to get the actual year).
+    /// The DS1307 counts every year that is divisible by 4 as a leap year, so this function does the same.
+    static uint8_t dagen_in_maand(uint8_t maand, uint8_t jaar){
+    static const uint8_t dagen[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (maand == 2 && jaar % 4 == 0){ //1952 is een schrikkeljaar, dus elk jaar deelbaar door 4 ook
+        return 29;
+    }
+    return dagen[maand - 1];
+}
+
 public:
+    /// \brief   
+    /// Decimal to BCD
+    /// \details
+    /// This function converts decimal integers to the binary-coded decimal (BCD) format
+    static uint8_t dec2bcd(uint8_t getal){
+    return ((getal/10 * 16) + (getal % 10));
+}
+
+    /// \brief   
+    /// BCD to decimal
+    /// \details
+    /// This function converts from the binary-coded decimal (BCD) format to decimal integers
+    static uint8_t bcd2dec(uint8_t getal){
+    return ((getal/16 * 10) + (getal % 16));
+}
+
     /// \brief   
     /// Constructor
     /// \details
@@ -204,6 +221,7 @@ public:
     /// Reads the date and time and returns it in an array.
     /// The array format is {dayname(int), daynumber, monthnumber, year, hour, minutes, seconds}
     uint8_t * uitlezen_bytes(){ //add 1952 to data[3] to get actual year
+        TRACE_SPAN(rtcRead);
         static uint8_t data[7];
         data[0] = lezen_dagnaam();
         data[1] = lezen_daggetal();
@@ -215,10 +233,105 @@ public:
         return data;
     }
 
+    /// \brief   
+    /// Date to timestamp
+    /// \details
+    /// Converts a date in the uitlezen_bytes format {dayname, daynumber, monthnumber, year, hour, minutes, seconds} to the amount of seconds since 1/1/1952 0:00:00.
+    /// The dayname is ignored because it follows from the date. The hour has to be in the 24 hour format.
+    static uint32_t tijdstip_van_datum(const uint8_t data[7]){
+        uint32_t dagen = 0;
+        for (uint8_t jaar = 0; jaar < data[3]; jaar++){
+            dagen += (jaar % 4 == 0) ? 366 : 365;
+        }
+        for (uint8_t maand = 1; maand < data[2]; maand++){
+            dagen += dagen_in_maand(maand, data[3]);
+        }
+        dagen += data[1] - 1;
+        return ((dagen * 24 + data[4]) * 60 + data[5]) * 60 + data[6];
+    }
+
+    /// \brief   
+    /// Timestamp to date
+    /// \details
+    /// Converts the amount of seconds since 1/1/1952 0:00:00 back to the uitlezen_bytes format {dayname, daynumber, monthnumber, year, hour, minutes, seconds}.
+    /// The hour is in the 24 hour format.
+    static void datum_van_tijdstip(uint32_t tijdstip, uint8_t data[7]){
+        data[6] = tijdstip % 60;
+        data[5] = (tijdstip / 60) % 60;
+        data[4] = (tijdstip / 3600) % 24;
+        uint32_t dagen = tijdstip / 86400;
+        data[0] = (dagen + 2) % 7 + 1; //1/1/1952 was een dinsdag, dinsdag is dag 3
+        uint8_t jaar = 0;
+        while (dagen >= uint32_t((jaar % 4 == 0) ? 366 : 365)){
+            dagen -= (jaar % 4 == 0) ? 366 : 365;
+            jaar++;
+        }
+        uint8_t maand = 1;
+        while (dagen >= dagen_in_maand(maand, jaar)){
+            dagen -= dagen_in_maand(maand, jaar);
+            maand++;
+        }
+        data[3] = jaar;
+        data[2] = maand;
+        data[1] = dagen + 1;
+    }
+
+    /// \brief   
+    /// Read date and time as timestamp
+    /// \details
+    /// Reads all the time registers in one i2c transaction and returns the amount of seconds since 1/1/1952 0:00:00.
+    /// This works in both the 12 and the 24 hour format. Because all registers are read at once the seconds can't roll over halfway like they can with uitlezen_bytes.
+    uint32_t lezen_tijdstip(){
+        TRACE_SPAN(rtcRead);
+        uint8_t registers[7];
+        { hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(adres);
+            wtrans.write(adres_secondes);}
+        { hwlib::i2c_read_transaction rtrans = ((hwlib::i2c_bus*)(&bus))->read(adres);
+            rtrans.read(registers, 7);}
+        uint8_t data[7];
+        data[0] = registers[3];
+        data[1] = bcd2dec(registers[4]);
+        data[2] = bcd2dec(registers[5]);
+        data[3] = bcd2dec(registers[6]);
+        if ((registers[2] >> 6 & 0x01)==1){ //12 uurs format, 12 AM is 0 uur en 12 PM is 12 uur
+            data[4] = bcd2dec(registers[2] & 0x1F) % 12;
+            if ((registers[2] >> 5 & 0x01)==1){
+                data[4] = data[4] + 12;
+            }
+        }else{
+            data[4] = bcd2dec(registers[2] & 0x3F);
+        }
+        data[5] = bcd2dec(registers[1]);
+        data[6] = bcd2dec(registers[0] & 0x7F); //meest linker bit is de oscilator
+        return tijdstip_van_datum(data);
+    }
+
+    /// \brief   
+    /// Write to the RAM
+    /// \details
+    /// Writes aantal bytes to the 56 bytes battery backed RAM of the DS1307, starting at positie (0 to 55).
+    /// The RAM keeps its data as long as the battery is connected, so it can be used to store settings.
+    void schrijven_ram(uint8_t positie, const uint8_t data[], uint8_t aantal){
+        { hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(adres);
+            wtrans.write(adres_ram + positie);
+            wtrans.write(data, aantal);}
+    }
+
+    /// \brief   
+    /// Read from the RAM
+    /// \details
+    /// Reads aantal bytes from the 56 bytes battery backed RAM of the DS1307, starting at positie (0 to 55).
+    void lezen_ram(uint8_t positie, uint8_t data[], uint8_t aantal){
+        { hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(adres);
+            wtrans.write(adres_ram + positie);}
+        { hwlib::i2c_read_transaction rtrans = ((hwlib::i2c_bus*)(&bus))->read(adres);
+            rtrans.read(data, aantal);}
+    }
+
     /// \brief   
     /// Fuction to turn on the oscilator
     /// \details
-    /// Turns on the oscilator, if it is already on then it gives a message through the terminal
+    /// Turns on the oscilator, if it is already on then it logs a warning (see stationLog)
     void aanzetten_oscilator(){
     { hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(adres);
         wtrans.write(adres_secondes);}
@@ -231,14 +344,14 @@ public:
         wtrans.write(adres_secondes);
         wtrans.write(code);}
     }else{
-        hwlib::cout << "Oscilator staat al aan! \n";
+        LOG_WARN(stationLog::oscillatorOn);
     }
 }
     
     /// \brief   
     /// Fuction to turn off the oscilator
     /// \details
-    /// Turns the oscilator off, if it is already off then it gives a message through the terminal
+    /// Turns the oscilator off, if it is already off then it logs a warning (see stationLog)
     void uitzetten_oscilator(){
         { hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(adres);
             wtrans.write(adres_secondes);}
@@ -251,7 +364,7 @@ public:
             wtrans.write(adres_secondes);
             wtrans.write(code);}
         }else{
-            hwlib::cout << "Oscilator staat al uit! \n";
+            LOG_WARN(stationLog::oscillatorOff);
         }
     }
     
@@ -282,7 +395,7 @@ public:
                 pakket = pakket | 0x03;
                 break;
             default:
-                hwlib::cout << "Onbekende modus \n";
+                LOG_ERROR(stationLog::unknownRate, rate_select);
         }
         { hwlib::i2c_write_transaction wtrans = ((hwlib::i2c_bus*)(&bus))->write(adres);
             wtrans.write(adres_control);
@@ -368,4 +481,7 @@ public:
     }
 };
 
+//the register addresses are constants in flash, the clock is its bus and the last read date
+static_assert(sizeof(DS1307) <= sizeof(void *) + 16, "DS1307 may not keep the register addresses in RAM");
+
 #endif
\ No newline at end of file
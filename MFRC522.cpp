@@ -7,6 +7,8 @@
 
 
 #include "MFRC522.hpp"
+#include "stationLog.hpp"
+#include "stationTrace.hpp"
 
 
 MFRC522::MFRC522(spiSetup& bus, hwlib::pin_out& slaveSel, hwlib::pin_out& reset):   //constructor for the class
@@ -33,25 +35,8 @@ void MFRC522::writeRegister(uint8_t regAddress, uint8_t writeBytes[], int amount
 
 //################################################################################################################
 
-void MFRC522::setBitMask(uint8_t regAddress, uint8_t mask){         //turn certain bits on in the given register address
-    uint8_t byteNow = readRegister(regAddress);
-    writeRegister(regAddress, byteNow | mask);
-}
-
-void MFRC522::clearBitMask(uint8_t regAddress, uint8_t mask){       //turn certain bits off in the given register address
-    uint8_t byteNow = readRegister(regAddress);
-    byteNow = byteNow & ~mask;
-    writeRegister(regAddress, byteNow);
-}
-
-//################################################################################################################
-
 void MFRC522::stateAntennas(bool state){    //turn the antenna's off or on with a boolean value
-    if(state){
-        setBitMask(TxControlReg, 0x03);     //8.6.3
-    }else{
-        clearBitMask(TxControlReg, 0x03);
-    }
+    writeFields(TxControl::Tx1RFEn::to(state) | TxControl::Tx2RFEn::to(state));     //8.6.3, the other bits are kept
 }
 
 uint8_t MFRC522::getVersion(){
@@ -59,7 +44,7 @@ uint8_t MFRC522::getVersion(){
 }
 
 void MFRC522::waitForBootUp(){
-    while(readRegister(CommandReg) & (1<<4)){}      //8.6.2. Checking this register to wait untill the powerdown bit is cleared
+    while(readField<Command::PowerDown>()){}      //8.6.2. Checking this register to wait untill the powerdown bit is cleared
 }
 
 void MFRC522::hardReset(){  //function to hardReset the MFRC522 by making the RST pin low for 105ns
@@ -71,13 +56,6 @@ void MFRC522::hardReset(){  //function to hardReset the MFRC522 by making the RS
     waitForBootUp();
 }
 
-void printByte2(uint8_t &byte){     //a function to print bytes
-    hwlib::cout<<"Byte: ";
-    for(int i = 7; i >= 0; i--){
-        hwlib::cout<<((byte & (1<<i)) !=0);
-    }
-    hwlib::cout<<'\n';
-}
 
 void MFRC522::softReset(){  //function to softReset the MFRC522 with a command
     writeRegister(CommandReg, cmdSoftReset);
@@ -85,21 +63,30 @@ void MFRC522::softReset(){  //function to softReset the MFRC522 with a command
     waitForBootUp();
 }
 
+void MFRC522::powerDown(){  //8.6.2. soft power-down, the field and the analog part are off but the registers keep their value
+    writeFields(Command::RcvOff::to<0>() | Command::PowerDown::to<1>() | Command::Cmd::to<cmdIdle>());
+}
+
+void MFRC522::powerUp(){    //out of the soft power-down, the field is back on when the oscillator runs again
+    writeRegister(CommandReg, cmdIdle);
+    waitForBootUp();
+}
+
 uint8_t MFRC522::checkError(){          //fucntion to check the error register per bit. Each bit has his own error value
     uint8_t errorReg = readRegister(ErrorReg);
-    if(errorReg & 0b00000001){
+    if(errorReg & Error::ProtocolErr::mask){
         return ProtocolErr;
-    }else if(errorReg & 0b00000010){
+    }else if(errorReg & Error::ParityErr::mask){
         return ParityErr;
-    }else if(errorReg & 0b00000100){
+    }else if(errorReg & Error::CRCErr::mask){
         return CRCErr;
-    }else if(errorReg & 0b00001000){
+    }else if(errorReg & Error::CollErr::mask){
         return CollErr;
-    }else if(errorReg & 0b00010000){
+    }else if(errorReg & Error::BufferOvfl::mask){
         return BufferOvrlErr;
-    }else if(errorReg & 0b01000000){
+    }else if(errorReg & Error::TempErr::mask){
         return TempErr;
-    }else if(errorReg & 0b10000000){
+    }else if(errorReg & Error::WrErr::mask){
         return WrErr;
     }else{
         return OkStatus;
@@ -110,7 +97,7 @@ uint8_t MFRC522::checkError(){          //fucntion to check the error register p
 
 //clears the fifo buffer with amntOfbytes of zeroes
 void MFRC522::clearFIFOBuffer(const uint8_t amntOfBytes){
-    writeRegister(FIFOLevelReg, 0x80);  //clears internal fifo buffer read and write pointer.
+    writeFields(FIFOLevel::FlushBuffer::to<1>());  //clears internal fifo buffer read and write pointer.
     uint8_t newFIFOBytes[amntOfBytes] = {0x00};
     writeRegister(FIFODataReg, newFIFOBytes, amntOfBytes);  //write amount of 0x00 to fifo buffer
 }
@@ -154,106 +141,177 @@ bool MFRC522::selfTest(){
     if(firmwareVersion == 0x91){    //test for firwareversion 1
         for(uint8_t i = 0; i < 64; i++){
             if(result[i] != selfTestFIFOBufferV1[i]){   //checks the buffer with the given value's  out of datasheet
-                hwlib::cout<<"Test for firwareVersion 1 did not pass\n";
+                LOG_ERROR(stationLog::selfTestFailed, firmwareVersion);
                 return false;
             }
         }
-        hwlib::cout<<"Test for firwareVersion 1 passed\n";
+        LOG_INFO(stationLog::selfTestPassed, firmwareVersion);
         return true;
     }else if(firmwareVersion == 0x92){  //test for firwareversion 2
         for(uint8_t i = 0; i < 64; i++){
             if(result[i] != selfTestFIFOBufferV2[i]){   //checks the buffer with the given value's  out of datasheet
-                hwlib::cout<<"Test for firwareVersion 2 did not pass\n";
+                LOG_ERROR(stationLog::selfTestFailed, firmwareVersion);
                 return false;
             }
         }
-        hwlib::cout<<"Test for firwareVersion 2 passed\n";
+        LOG_INFO(stationLog::selfTestPassed, firmwareVersion);
         return true;
     }else{
-        hwlib::cout<<"No version detected, is the MFRC522 connected correctly?\n";
+        LOG_ERROR(stationLog::noVersion, firmwareVersion);
         return false;
     }
 }
 
 void MFRC522::initialize(){    //initialize the chip when you start it up 
     hardReset();
+    configure();
+}
 
-    writeRegister(TModeReg, 0x80); //start the auto time
-    writeRegister(TxModeReg, 0x00); //set tx and rx to 106kb transfer and receive speed.
-    writeRegister(RxModeReg, 0x00);
-    writeRegister(ModWidthReg, 0x80); //reset ModWidthReg 
-
-    writeRegister(TPrescalerReg, 0xA9); //169 for a 30khz timer = 25us
-    writeRegister(TReloadRegH, 0x03);   //169 in bits (0x03E8)
-    writeRegister(TReloadRegL, 0xE8);   //169 in bits (0x03E8)
+void MFRC522::configure(){      //the configuration without the reset, for readers that share their reset pin
+    for(uint8_t i = 0; i < configurationSize; i++){     //whole registers from their reset value, so no reads. The antennas are in it
+        writeRegister(configuration[i].address, configuration[i].value);
+    }
+}
 
-    writeRegister(TxASKReg, 0x40); //100%ask becuase we use mifare card and that is rfid and not nfc
-    writeRegister(ModeReg, 0x3D);   //crc init value 0x6363
+bool MFRC522::isConfigured(){   //the version and the configuration with the antennas in one read, a fingerprint of a chip initialize() was done on
+    uint8_t addresses[configurationSize + 2] = {VersionReg, CommandReg};
+    for(uint8_t i = 0; i < configurationSize; i++){
+        addresses[2 + i] = configuration[i].address;
+    }
+    uint8_t values[configurationSize + 2];
+    bus.getBytesFromRegisters(addresses, values, configurationSize + 2, slaveSel);
+    if((values[0] != 0x91 && values[0] != 0x92) || Command::PowerDown::from(values[1])){    //no chip or powered down
+        return false;
+    }
+    for(uint8_t i = 0; i < configurationSize; i++){
+        if((values[2 + i] ^ configuration[i].value) & configuration[i].stored){   //read-only bits read back as the chip likes
+            return false;
+        }
+    }
+    return true;
+}
 
-    writeRegister(RFCfgReg, (0x07<<4));
-    //turn antennas on(true is on)
-    stateAntennas(true);
+bool MFRC522::fastInitialize(){     //after a watchdog or brown-out restart of the Due the chip may still be configured, returns true when the reset was skipped
+    if(!isConfigured()){
+        initialize();
+        return false;
+    }
+    resume();
+    return true;
+}
 
+void MFRC522::resume(){     //a configured chip after a restart of the Due
+    writeRegister(CommandReg, cmdIdle); //a command from before the restart may still be running
+    stopCrypto();                       //and a card may still be authenticated
 }
 
 
-uint8_t MFRC522::communicate(uint8_t cmd, uint8_t sendData[], int sendDataLength, uint8_t receivedData[] = {0}, int receivedDataLength = 0){
-    uint8_t finishedIrq = 0x00; //value of interupts when finished or triggered
-    if(cmd == cmdTransceive){   //the right value's for the transceive command
-        finishedIrq = 0x30;
-    }
-    if(cmd == cmdMFAuthent){
-        finishedIrq = 0x10;
-    }
+void MFRC522::setIdleWork(idleWork * work){      //work done by communicate while waiting, nullptr for none
+    idle = work;
+}
+
+void MFRC522::startCommand(uint8_t cmd, const cardFrame & send){     //puts the frame in the FIFO and starts the command, returns at once
     writeRegister(CommandReg, cmdIdle); //stop any active command
-    writeRegister(ComIrqReg, 0x7F); //the interrupt request bits.
-    writeRegister(FIFOLevelReg, 0x80); //Flush buffer = 1, Initalize the FIFO
+    writeFields(ComIrq::Set1::to<0>() | ComIrq::Requests::to<0x7F>()); //clear the interrupt request bits.
+    writeFields(FIFOLevel::FlushBuffer::to<1>()); //Initalize the FIFO
 
 
-    for(int i = 0; i < sendDataLength; i++){
-        writeRegister(FIFODataReg, sendData[i]);
+    for(uint8_t i = 0; i < send.length(); i++){
+        writeRegister(FIFODataReg, send[i]);
+    }
+    //the frame says how many bits of its last byte are sent, 7 for a REQA or WUPA, so the callers don't set the framing
+    auto framing = BitFraming::RxAlign::to<0>() | BitFraming::TxLastBits::to(send.lastBits());
+    if(cmd == cmdTransmit){     //starts at once, the framing has to be there first
+        writeFields(BitFraming::StartSend::to<0>() | framing);
     }
     //execute command
     writeRegister(CommandReg, cmd); //executes the given command as parameter
 
     if(cmd == cmdTransceive){
-        setBitMask(BitFramingReg, 0x80); //StartSend = 1, transmission starts
+        writeFields(BitFraming::StartSend::to<1>() | framing); //transmission starts, one write with the framing
     }
+}
 
-    int timeOutMS = 25; //maximum timeout time in ms
+uint8_t MFRC522::commandStatus(uint8_t cmd){     //one look at the interrupts: Busy, TimeOut from the timer, or OkStatus when the command is done
+    uint8_t finishedIrq = 0x00; //value of interupts when finished or triggered
+    if(cmd == cmdTransceive){   //the right value's for the transceive command
+        finishedIrq = ComIrq::RxIRq::mask | ComIrq::IdleIRq::mask;
+    }
+    if(cmd == cmdMFAuthent){
+        finishedIrq = ComIrq::IdleIRq::mask;
+    }
+    if(cmd == cmdTransmit){     //only sending, done as soon as the data is out
+        finishedIrq = ComIrq::TxIRq::mask;
+    }
     uint8_t curInterupt = readRegister(ComIrqReg);  //get the currentinterupt status
-    for(int i = 0; !(curInterupt & finishedIrq); i++){   //loops until the time out is reached or triggered by the bit. Or the curInterupt is not equal
-        curInterupt = readRegister(ComIrqReg);  //to the finishedIRq anymore
-        if((i > timeOutMS) || (curInterupt & 0x01)){    //0x01 is interrupt for timeout
-            return TimeOut; //returns there is a timeout can be the interrupt or the ms timeout
-        }
-        hwlib::wait_ms(1);
+    if(curInterupt & finishedIrq){
+        return OkStatus;
+    }
+    if(curInterupt & ComIrq::TimerIRq::mask){
+        return TimeOut;
     }
+    return Busy;
+}
 
+uint8_t MFRC522::finishCommand(cardFrame & received){  //reads the answer of a finished command into received, never beyond its capacity
     uint8_t error = checkError();   //check for errors in the register and returns this else continue's
     if(error){
         return error;   //returns the error given
     }
 
-    //reading the result of the fifo
-    receivedDataLength = readRegister(FIFOLevelReg); //get the lenght of the received data in the FIFO buffer
-    readRegister(FIFODataReg, receivedDataLength, receivedData); //reads the received data out of the fifo buffer into the array
+    //reading the result of the fifo, a frame without capacity doesn't want an answer
+    uint8_t status = OkStatus;
+    uint8_t length = received.capacity() > 0 ? readField<FIFOLevel::Level>() : 0; //get the lenght of the received data in the FIFO buffer
+    if(length > received.capacity()){   //the rest stays in the FIFO, it is flushed by the next command
+        LOG_WARN(stationLog::answerTooLong, length, received.capacity());
+        length = received.capacity();
+        status = BufferOvrlErr;
+    }
+    if(length > 0){
+        readRegister(FIFODataReg, length, received.data()); //reads the received data out of the fifo buffer into the frame
+    }
+    //RxLastBits, only a one byte answer can be part of a byte: the 4 bit ACK and NAK of a MIFARE card
+    received.resize(length, length == 1 ? readField<Control::RxLastBits>() : 0);
     writeRegister(CommandReg, cmdIdle); //stop any commands
-    return OkStatus;    //if everything went well return okstatus
+    return status;    //if everything went well return okstatus
+}
+
+uint8_t MFRC522::communicate(uint8_t cmd, const cardFrame & send, cardFrame & received){   //sends the frame and reads the answer into received, never beyond its capacity
+    TRACE_SPAN(communicate);
+    startCommand(cmd, send);
+
+    uint_fast64_t deadline = hwlib::now_us() + 25000; //maximum timeout time is 25 ms
+    uint8_t status = commandStatus(cmd);
+    while(status == Busy){      //loops until the time out is reached or triggered by the bit
+        if(hwlib::now_us() > deadline){
+            return TimeOut; //the timer interrupt is seen by commandStatus, this is the ms timeout
+        }
+        if(idle != nullptr){    //use the time the card needs to answer for other work
+            idle->whileWaiting();
+        }
+        status = commandStatus(cmd);
+    }
+    if(status != OkStatus){
+        return status;
+    }
+    return finishCommand(received);
+}
+
+uint8_t MFRC522::communicate(uint8_t cmd, const cardFrame & send){  //for commands without an answer, the FIFO is not read and flushed by the next command
+    cardFrame none(nullptr, 0);
+    return communicate(cmd, send, none);
 }
 
 bool MFRC522::isCardPresented(){     //function does not work yet completly, can only see once if a card is presented.
     //REQA = 26h       both 7 bits 
     //WUPA = 52h
-    writeRegister(BitFramingReg, 0x07); //0x07 00000111 indicates 7 bits of REQA and WUPA
+	uint8_t sendData[1] = {mifareReqa}; //send the mifare request command
+    cardFrame request(sendData, 1, 1);
+    request.resize(1, 7);               //REQA and WUPA are 7 bits
+	uint8_t receivedData[2] = {0x00}; //the ATQA, 2 bytes
+    cardFrame answer(receivedData);
 
-    const uint8_t sendDataLength = 1;   //one byte of data is send, the command
-	uint8_t sendData[sendDataLength] = {mifareReqa}; //send the mifare request command
-
-	int receivedLength = 2; //returns 2 bytes of data
-	uint8_t receivedData[receivedLength] = {0x00}; //array to be filled with the received data
-
-    uint8_t status = communicate(cmdTransceive, sendData, sendDataLength, receivedData, receivedLength); //get the communication status of the chip and card
+    uint8_t status = communicate(cmdTransceive, request, answer); //get the communication status of the chip and card
 
     if(status != OkStatus){ //checks if the status is OK, if not there is no card presented.
         return false;
@@ -262,6 +320,39 @@ bool MFRC522::isCardPresented(){     //function does not work yet completly, can
     return true;    //if card is presented
 }
 
+void MFRC522::startRequest(){      //a REQA that runs on its own, so other readers can be used while this one waits for a card
+	uint8_t sendData[1] = {mifareReqa};
+    cardFrame request(sendData, 1, 1);
+    request.resize(1, 7);               //7 bits
+    startCommand(cmdTransceive, request);
+}
+
+uint8_t MFRC522::requestStatus(){   //Busy while the REQA of startRequest runs, then OkStatus when a card sent its ATQA
+    uint8_t status = commandStatus(cmdTransceive);
+    if(status != OkStatus){
+        return status;
+    }
+	uint8_t receivedData[2] = {0x00}; //the ATQA, 2 bytes
+    cardFrame answer(receivedData);
+    return finishCommand(answer);
+}
+
+uint8_t MFRC522::wakeUpCard(){     //WUPA, like REQA but a halted card answers too. Returns the status, for a reselect after an error
+	uint8_t sendData[1] = {mifareWupa};
+    cardFrame request(sendData, 1, 1);
+    request.resize(1, 7);               //7 bits, like the REQA
+	uint8_t receivedData[2] = {0x00}; //the ATQA, 2 bytes
+    cardFrame answer(receivedData);
+    return communicate(cmdTransceive, request, answer);
+}
+
+void MFRC522::resetField(){     //field off and on, every card in it starts again in IDLE
+    stateAntennas(false);
+    hwlib::wait_ms(1);      //long enough for the card to lose its power
+    stateAntennas(true);
+    hwlib::wait_ms(5);      //the card needs its power up time before it answers
+}
+
 bool MFRC522::cardCheck(){
     if(isCardPresented()){
         stateAntennas(false);   //mfrc522 needs short pauses between transmitting so turning off antenna's and on again does this
@@ -272,27 +363,40 @@ bool MFRC522::cardCheck(){
 }
 
 uint8_t MFRC522::getUID(uint8_t uid[5]){            //Cascade level 1 check that returns the UI
-    uint8_t comm[2] = {0x93, 0x20};
-
-    //no REQA or WUPA so 111bit framing can be turned off
-    clearBitMask(CollReg, 0x80);
-    writeRegister(BitFramingReg, 0x00);
+    TRACE_SPAN(anticollision);
+    uint8_t comm[2] = {0x93, 0x20};     //whole bytes, the framing of the REQA is not used. ValuesAfterColl is off since configure()
 
-    uint8_t status = communicate(cmdTransceive, comm, 2, uid, 5);   //communicate to get the UID of the card.
+    cardFrame answer(uid, 5);
+    uint8_t status = communicate(cmdTransceive, cardFrame(comm, 2, 2), answer);   //communicate to get the UID of the card.
     if(status != OkStatus){
         return status;
     }
+    if(answer.length() != 5){   //4 bytes UID and the BCC
+        return ProtocolErr;
+    }
     return OkStatus;
 }
 
-void MFRC522::waitForUID(uint8_t UID[5]){       //wait for the cards UID and puts this into the array.
-    while(true){
-        if(isCardPresented()){                  //wait for a card to be presented
-            if(getUID(UID)== OkStatus){         //communicates with the card to ge the UID
-                return;
-            }
-        }
+bool MFRC522::pollUID(uint8_t UID[5]){      //one try to get the UID of a card, returns at once when there is no card
+    TRACE_SPAN(detect);
+    return isCardPresented() && getUID(UID) == OkStatus;
+}
+
+bool MFRC522::pollUID(uint8_t UID[5], tickSource & clock, uint32_t & latched){   //same as pollUID, but latches the clock
+    TRACE_SPAN(detect);
+    if(isCardPresented() && getUID(UID) == OkStatus){                              //at the moment the UID is received
+        latched = clock.ticks();
+        return true;
     }
+    return false;
+}
+
+void MFRC522::waitForUID(uint8_t UID[5]){       //wait for the cards UID and puts this into the array.
+    while(!pollUID(UID)){}
+}
+
+void MFRC522::waitForUID(uint8_t UID[5], tickSource & clock, uint32_t & latched){
+    while(!pollUID(UID, clock, latched)){}
 }
 
 bool MFRC522::checkBCC(uint8_t UID[5]){     //functios that calculates the BCC to check if the UID is valid
@@ -304,13 +408,8 @@ bool MFRC522::checkBCC(uint8_t UID[5]){     //functios that calculates the BCC t
     return (BCC == UID[4]);         //returns if the BCC is the same as the calculated BCC
 }
 
-bool MFRC522::isUIDEqual(const uint8_t cardUID[5], const uint8_t checkUID[5]){      //check if two UID's are equal
-    for(int i = 0; i < 4; i++){
-        if(cardUID[i] != checkUID[i]){
-            return false;
-        }
-    }
-    return true;
+bool MFRC522::isUIDEqual(const uint8_t UID[5], const uint8_t checkUID[4]){      //check if two UID's are equal, the BCC is not compared
+    return cardUID(UID) == cardUID(checkUID);
 }
 
 
@@ -323,15 +422,16 @@ void MFRC522::printUID(uint8_t UID[5]){         //print an UID without the BCC
 }
 
 uint8_t MFRC522::calculateCRC(uint8_t data[], int lenght, uint8_t result[]){
+    TRACE_SPAN(calculateCRC);
     writeRegister(CommandReg, cmdIdle); //stop any active commands
-    writeRegister(DivIrqReg, 0x04);     //enable crc interrupt
-    setBitMask(FIFOLevelReg, 0x80);     //flush the FIFO buffer
+    writeFields(DivIrq::Set2::to<0>() | DivIrq::CRCIRq::to<1>());  //clear the crc interrupt
+    writeFields(FIFOLevel::FlushBuffer::to<1>());   //flush the FIFO buffer
     writeRegister(FIFODataReg, data, lenght); //write data to the fifo
     writeRegister(CommandReg, cmdCalcCRC);  //start the CRC command
     int count = 0;
     for(int i = 0; i < 100; i++){   //wait max 100ms
         uint8_t curDivIrq = readRegister(DivIrqReg);
-        if(curDivIrq & 0x04){   //CRCirq is triggered so caclucation is done
+        if(curDivIrq & DivIrq::CRCIRq::mask){   //CRCirq is triggered so caclucation is done
             break;
         }
         count++;
@@ -350,13 +450,10 @@ uint8_t MFRC522::calculateCRC(uint8_t data[], int lenght, uint8_t result[]){
 }
 
 uint8_t MFRC522::selectCard(uint8_t UID[5]){
+    TRACE_SPAN(select);
     int uidIndex = 2;   //index to fill the buffer correctly
-    uint8_t *receivedBuffer;
-    int receivedBufLength;
     uint8_t buffer[9] = {0x00};
 
-    clearBitMask(CollReg, 0x80);
-
     buffer[0] = 0x93;   //select card command
     buffer[1] = 0x70;
 
@@ -369,45 +466,40 @@ uint8_t MFRC522::selectCard(uint8_t UID[5]){
     }
     uint8_t calcCRCStatus = calculateCRC(buffer, 7, &buffer[7]);    //calculate CRC
     if(calcCRCStatus != OkStatus){                                  //check if the crc is calculated correct.
-        hwlib::cout<<"CRCerr\n";
-        hwlib::cout<<hwlib::hex<<calcCRCStatus;
+        LOG_WARN(stationLog::selectCRCFailed, calcCRCStatus);
         return CRCErr;
     }
-    // for(int i = 0; i < 9; i++){                //prints the buffer to test
-    //     hwlib::cout<<hwlib::hex<<buffer[i]<<hwlib::endl;
-    // }
-    // hwlib::cout<<"-----------------\n";
-    receivedBuffer = &buffer[6];
-    receivedBufLength = 3;
-    uint8_t comStatus = communicate(cmdTransceive, buffer, 9, receivedBuffer, receivedBufLength);
+    cardFrame request(buffer, 9, 9);
+    cardFrame answer = request.from(6);     //SAK and CRC_A come in over the BCC and CRC, they are sent by then
+    uint8_t comStatus = communicate(cmdTransceive, request, answer);
+    if(comStatus == OkStatus && answer.length() != 3){
+        comStatus = ProtocolErr;
+    }
     if(comStatus != OkStatus){
-        hwlib::cout<<"NOT OK"<<hwlib::endl;
-        printByte2(comStatus);
+        LOG_WARN(stationLog::selectFailed, comStatus);
         return comStatus;
     }
-    //check for SAK response buffer[6] == 8
-    if(buffer[6] != 0x08){
-        hwlib::cout<<"No SAK response...\n";
+    //check for SAK response answer[0] == 8
+    if(answer[0] != 0x08){
+        LOG_WARN(stationLog::noSAK, answer[0]);
     }
     //calculate your own CRC_A to check if its correct.
-    calcCRCStatus = calculateCRC(receivedBuffer, 1, &buffer[2]);
+    calcCRCStatus = calculateCRC(answer.data(), 1, &buffer[2]);
     if(calcCRCStatus != OkStatus){
-        hwlib::cout<<hwlib::hex<<calcCRCStatus;
+        LOG_WARN(stationLog::selectCRCFailed, calcCRCStatus);
         return CRCErr;
     }
-    if(buffer[2] != receivedBuffer[1] || buffer[3] != receivedBuffer[2]){   //check the CRC calculated bytes
-        hwlib::cout<<"CRC is wrong\n";
+    if(buffer[2] != answer[1] || buffer[3] != answer[2]){   //check the CRC calculated bytes
+        LOG_WARN(stationLog::selectCRCWrong);
         return CRCErr;
     }
-    for(int i = 0; i < 9; i++){                //prints the buffer to test
-        hwlib::cout<<hwlib::hex<<buffer[i]<<hwlib::endl;
-    }
+    LOG_DEBUG(stationLog::selected, uint32_t(UID[0]) << 24 | uint32_t(UID[1]) << 16 | uint32_t(UID[2]) << 8 | UID[3], answer[0]);
     return OkStatus;
 }
 
-uint8_t MFRC522::authenticateCard(uint8_t cmd, uint8_t blockAddress, uint8_t sectorKey[6], uint8_t uid[4]){
+uint8_t MFRC522::authenticateCard(uint8_t cmd, uint8_t blockAddress, const uint8_t sectorKey[6], const uint8_t uid[4]){
+    TRACE_SPAN(authenticate);
     uint8_t buffer[12] = {0};
-    int bufLenght = 12;
     //fill the buffer that is used to communicate with the correct bytes.
     buffer[0] = cmd;
     buffer[1] = blockAddress;
@@ -417,24 +509,95 @@ uint8_t MFRC522::authenticateCard(uint8_t cmd, uint8_t blockAddress, uint8_t sec
     for(int i = 0; i < 4; i++){
         buffer[8+i] = uid[i];
     }
-    uint8_t status = communicate(cmdMFAuthent, buffer, bufLenght);
+    uint8_t status = communicate(cmdMFAuthent, cardFrame(buffer, 12, 12));
     if(status != OkStatus){
-        hwlib::cout<<"Not authenticated....\n";
+        LOG_WARN(stationLog::notAuthenticated, blockAddress, status);
         return status;
     }else{
-        hwlib::cout<<"Authenticated...\n";
+        LOG_DEBUG(stationLog::authenticated, blockAddress);
         return OkStatus;
     }
 }
 
-uint8_t MFRC522::readBlockFromCard(){
+uint8_t MFRC522::readBlockFromCard(uint8_t blockAddress, uint8_t data[16]){   //reads one block of 16 bytes, the sector must be authenticated
+    TRACE_SPAN(read);
+    uint8_t buffer[18] = {0};   //16 bytes of data and 2 bytes CRC_A
+    buffer[0] = mifareRead;
+    buffer[1] = blockAddress;
+    uint8_t status = calculateCRC(buffer, 2, &buffer[2]);
+    if(status != OkStatus){
+        return status;
+    }
+    cardFrame answer(buffer);   //the answer comes in over the command
+    status = communicate(cmdTransceive, cardFrame(buffer, 18, 4), answer);
+    if(status != OkStatus){
+        return status;
+    }
+    if(answer.length() != 18){
+        return answer.length() == 1 ? Statuserr : ProtocolErr;   //a NAK of 4 bits, or a broken answer
+    }
+    uint8_t crc[2] = {0};
+    status = calculateCRC(buffer, 16, crc);     //check the CRC_A the card added to the data
+    if(status != OkStatus){
+        return status;
+    }
+    if(crc[0] != buffer[16] || crc[1] != buffer[17]){
+        return CRCErr;
+    }
+    for(int i = 0; i < 16; i++){
+        data[i] = buffer[i];
+    }
     return OkStatus;
 }
 
-uint8_t MFRC522::writeToBlockOnCard(){
+uint8_t MFRC522::writeToBlockOnCard(uint8_t blockAddress, const uint8_t data[16]){    //writes one block of 16 bytes, the sector must be authenticated
+    TRACE_SPAN(write);
+    uint8_t buffer[18] = {0};
+    uint8_t ackByte[1] = {0};   //the card answers with a 4 bit ACK (0x0A) after each part
+    cardFrame ack(ackByte);
+    buffer[0] = mifareWrite;
+    buffer[1] = blockAddress;
+    uint8_t status = calculateCRC(buffer, 2, &buffer[2]);
+    if(status != OkStatus){
+        return status;
+    }
+    status = communicate(cmdTransceive, cardFrame(buffer, 18, 4), ack);
+    if(status != OkStatus){
+        return status;
+    }
+    if(ack.length() != 1 || (ack[0] & 0x0F) != 0x0A){
+        return Statuserr;
+    }
+    for(int i = 0; i < 16; i++){    //second part is the data itself
+        buffer[i] = data[i];
+    }
+    status = calculateCRC(buffer, 16, &buffer[16]);
+    if(status != OkStatus){
+        return status;
+    }
+    status = communicate(cmdTransceive, cardFrame(buffer, 18, 18), ack);
+    if(status != OkStatus){
+        return status;
+    }
+    if(ack.length() != 1 || (ack[0] & 0x0F) != 0x0A){
+        return Statuserr;
+    }
     return OkStatus;
 }
 
+uint8_t MFRC522::haltCard(){      //puts the card in the HALT state, it won't answer a REQA until it has left the field
+    uint8_t buffer[4] = {mifareHalt, 0x00, 0x00, 0x00};
+    uint8_t status = calculateCRC(buffer, 2, &buffer[2]);
+    if(status != OkStatus){
+        return status;
+    }
+    return communicate(cmdTransmit, cardFrame(buffer, 4, 4));    //a halted card doesn't answer, so there is no need to wait for the time out
+}
+
+void MFRC522::stopCrypto(){     //ends the authenticated session so a new card can be selected
+    writeFields(Status2::MFCrypto1On::to<0>()); //9.3.1.9, a read-modify-write that keeps the other bits
+}
+
 
 void MFRC522::test() {
 	initialize();
@@ -448,7 +611,7 @@ void MFRC522::test() {
 
     //get card uid
 	uint8_t uid[5] = {0x00};
-    uint8_t authenticatedUID[4] = {0xD0, 0x3F, 0x7B, 0xA6};
+    constexpr cardUID authenticatedUID(0xD0, 0x3F, 0x7B, 0xA6);
     waitForUID(uid);
     printUID(uid);
     //checks if the UID is valid with BCC
@@ -456,7 +619,7 @@ void MFRC522::test() {
         hwlib::cout<<"UID is valid\n";
     }
     //check if the UID is equal to a given UID
-    if(isUIDEqual(uid, authenticatedUID)){
+    if(cardUID(uid) == authenticatedUID){
         hwlib::cout<<"UID is equal\n";
     }else{
         hwlib::cout<<"UID is not equal\n";
@@ -11,7 +11,21 @@
 
 #include "hwlib.hpp"
 #include "spiSetup.hpp"
-
+#include "tickSource.hpp"
+#include "cardUID.hpp"
+#include "cardFrame.hpp"
+#include "registerField.hpp"
+
+
+/// @brief
+/// Work that can be done while the MFRC522 waits for the card
+/// @detail
+/// communicate() calls whileWaiting() every time it has checked that the card did not answer yet.
+/// It must be short and must not use the MFRC522 itself.
+class idleWork {
+public:
+    virtual void whileWaiting() = 0;
+};
 
 class MFRC522 {
 private:
@@ -19,6 +33,7 @@ private:
     spiSetup &bus;
     hwlib::pin_out& slaveSel;
     hwlib::pin_out& reset;
+    idleWork * idle = nullptr;
 public:
    
     //const static uint8_t reserved         = 0x00;
@@ -89,6 +104,88 @@ public:
     //const static uint8_t reserved         = 0x3E;
     //const static uint8_t reserved         = 0x3F;
 
+    /// @brief The registers with fields the driver uses, out of chapter 9 of the datasheet.
+    /// Field updates of one register combine into one write, see registerField.hpp.
+    struct Command : chipRegister< CommandReg, 0x20, 0x3F > {
+        using RcvOff            = registerField< Command, 5 >;      ///< Analog part of the receiver off.
+        using PowerDown         = registerField< Command, 4 >;      ///< Soft power-down, reads 1 until the chip is up.
+        using Cmd               = registerField< Command, 0, 4 >;   ///< The command, cmdIdle and the others below.
+    };
+    struct ComIrq : chipRegister< ComIrqReg, 0x14, 0x00 > {
+        using Set1              = registerField< ComIrq, 7 >;       ///< 1 sets the marked bits, 0 clears them.
+        using Requests          = registerField< ComIrq, 0, 7 >;    ///< All request bits below.
+        using TxIRq             = registerField< ComIrq, 6 >;
+        using RxIRq             = registerField< ComIrq, 5 >;
+        using IdleIRq           = registerField< ComIrq, 4 >;
+        using TimerIRq          = registerField< ComIrq, 0 >;
+    };
+    struct DivIrq : chipRegister< DivIrqReg, 0x00, 0x00 > {
+        using Set2              = registerField< DivIrq, 7 >;       ///< 1 sets the marked bits, 0 clears them.
+        using CRCIRq            = registerField< DivIrq, 2 >;
+    };
+    struct Error : chipRegister< ErrorReg, 0x00, 0x00 > {
+        using WrErr             = readOnlyField< Error, 7 >;
+        using TempErr           = readOnlyField< Error, 6 >;
+        using BufferOvfl        = readOnlyField< Error, 4 >;
+        using CollErr           = readOnlyField< Error, 3 >;
+        using CRCErr            = readOnlyField< Error, 2 >;
+        using ParityErr         = readOnlyField< Error, 1 >;
+        using ProtocolErr       = readOnlyField< Error, 0 >;
+    };
+    struct Status2 : chipRegister< Status2Reg, 0x00, 0xC8 > {
+        using MFCrypto1On       = registerField< Status2, 3 >;      ///< Set by MFAuthent, only the driver clears it.
+    };
+    struct FIFOLevel : chipRegister< FIFOLevelReg, 0x00, 0x00 > {
+        using FlushBuffer       = registerField< FIFOLevel, 7 >;
+        using Level             = readOnlyField< FIFOLevel, 0, 7 >; ///< Bytes in the FIFO.
+    };
+    struct Control : chipRegister< ControlReg, 0x10, 0x00 > {
+        using RxLastBits        = readOnlyField< Control, 0, 3 >;   ///< Valid bits of the last byte received, 0 for a whole byte.
+    };
+    struct BitFraming : chipRegister< BitFramingReg, 0x00, 0xF7 > {
+        using StartSend         = registerField< BitFraming, 7 >;   ///< Starts the transmission of a Transceive.
+        using RxAlign           = registerField< BitFraming, 4, 3 >;
+        using TxLastBits        = registerField< BitFraming, 0, 3 >;///< Bits of the last byte sent, 0 for a whole byte.
+    };
+    struct Coll : chipRegister< CollReg, 0x80, 0x80 > {
+        using ValuesAfterColl   = registerField< Coll, 7 >;         ///< 0 clears the bits received after a collision.
+    };
+    struct Mode : chipRegister< ModeReg, 0x3F > {
+        using CRCPreset         = registerField< Mode, 0, 2 >;      ///< 1 for 0x6363, the CRC_A of ISO 14443-3.
+    };
+    struct TxMode : chipRegister< TxModeReg, 0x00 > {
+        using TxSpeed           = registerField< TxMode, 4, 3 >;    ///< 0 for 106 kBd.
+    };
+    struct RxMode : chipRegister< RxModeReg, 0x00 > {
+        using RxSpeed           = registerField< RxMode, 4, 3 >;    ///< 0 for 106 kBd.
+    };
+    struct TxControl : chipRegister< TxControlReg, 0x80, 0xFB > {
+        using Tx2RFEn           = registerField< TxControl, 1 >;    ///< 8.6.3, the antenna drivers.
+        using Tx1RFEn           = registerField< TxControl, 0 >;
+    };
+    struct TxASK : chipRegister< TxASKReg, 0x00 > {
+        using Force100ASK       = registerField< TxASK, 6 >;
+    };
+    struct ModWidth : chipRegister< ModWidthReg, 0x26 > {
+        using Width             = registerField< ModWidth, 0, 8 >;
+    };
+    struct RFCfg : chipRegister< RFCfgReg, 0x48 > {
+        using RxGain            = registerField< RFCfg, 4, 3 >;     ///< 7 for 48 dB, the most.
+    };
+    struct TMode : chipRegister< TModeReg, 0x00 > {
+        using TAuto             = registerField< TMode, 7 >;        ///< The timer starts at the end of a transmission.
+        using TPrescalerHi      = registerField< TMode, 0, 4 >;
+    };
+    struct TPrescaler : chipRegister< TPrescalerReg, 0x00 > {
+        using TPrescalerLo      = registerField< TPrescaler, 0, 8 >;
+    };
+    struct TReloadH : chipRegister< TReloadRegH, 0x00 > {
+        using Value             = registerField< TReloadH, 0, 8 >;
+    };
+    struct TReloadL : chipRegister< TReloadRegL, 0x00 > {
+        using Value             = registerField< TReloadL, 0, 8 >;
+    };
+
     /// https://www.nxp.com/docs/en/data-sheet/MFRC522.pdf
     const static uint8_t cmdIdle            = 0x00;     /// @brief No action, cancels the current command execution.
     const static uint8_t cmdMem             = 0x01;     /// @brief Stores 25 bytes into the internal buffer.
@@ -128,14 +225,33 @@ public:
     const static uint8_t WrErr              = 0x07;     /// @brief
     const static uint8_t TimeOut            = 0x08;     /// @brief
     const static uint8_t BCCErr             = 0x09;     /// @brief BCC calculation error.
+    const static uint8_t Busy               = 0x0A;     /// @brief The command is still running.
     const static uint8_t Statuserr          = 0x10;     /// @brief General status error.
 
 
-    
-    const uint8_t FIFOAmountOfBytes = 64;
+    /// @brief Registers that initialize() writes, with their values.
+    /// A chip that still has all these values after a restart of the Due is configured, see fastInitialize().
+    static constexpr registerValue configuration[] = {
+        afterReset(TMode::TAuto::to<1>()),                          //start the timer at the end of every transmission
+        afterReset(TxMode::TxSpeed::to<0>()),                       //set tx and rx to 106kb transfer and receive speed.
+        afterReset(RxMode::RxSpeed::to<0>()),
+        afterReset(ModWidth::Width::to<0x80>()),
+        afterReset(TPrescaler::TPrescalerLo::to<0xA9>()),           //169 for a 30khz timer = 25us
+        afterReset(TReloadH::Value::to<0x03>()),                    //169 in bits (0x03E8)
+        afterReset(TReloadL::Value::to<0xE8>()),
+        afterReset(TxASK::Force100ASK::to<1>()),                    //100%ask becuase we use mifare card and that is rfid and not nfc
+        afterReset(Mode::CRCPreset::to<1>()),                       //crc init value 0x6363
+        afterReset(RFCfg::RxGain::to<7>()),
+        afterReset(Coll::ValuesAfterColl::to<0>()),                 //once here instead of before every anticollision and select
+        afterReset(TxControl::Tx1RFEn::to<1>() | TxControl::Tx2RFEn::to<1>())    //antennas on, last so the field comes up configured
+    };
+    const static uint8_t configurationSize = sizeof(configuration) / sizeof(configuration[0]);
 
-    
-	const uint8_t selfTestFIFOBufferV1[64] {
+    const static uint8_t FIFOAmountOfBytes = 64;
+
+    /// @brief Self test result out of datasheet for version 1.
+    /// The tables are static constexpr so they stay in flash, instead of 128 bytes of RAM in every reader.
+	static constexpr uint8_t selfTestFIFOBufferV1[64] = {
 		0x00, 0xC6, 0x37, 0xD5, 0x32, 0xB7, 0x57, 0x5C,
 		0xC2, 0xD8, 0x7C, 0x4D, 0xD9, 0x70, 0xC7, 0x73,
 		0x10, 0xE6, 0xD2, 0xAA, 0x5E, 0xA1, 0x3E, 0x5A,
@@ -148,7 +264,7 @@ public:
 
     /// @brief Self test result out of datasheet for version 2. 
     /// After running the self test this will be in the FIFO Buffer.
-	const uint8_t selfTestFIFOBufferV2[64] {
+	static constexpr uint8_t selfTestFIFOBufferV2[64] = {
 		0x00, 0xEB, 0x66, 0xBA, 0x57, 0xBF, 0x23, 0x95,
 		0xD0, 0xE3, 0x0D, 0x3D, 0x27, 0x89, 0x5C, 0xDE,
 		0x9D, 0x3B, 0xA7, 0x00, 0x21, 0x5B, 0x89, 0x82,
@@ -173,9 +289,17 @@ public:
 
 //################################################################################################################
 
-    void setBitMask(uint8_t regAddress, uint8_t mask);
+    /// @brief Write fields of one register: one write when the update decides every stored bit, else a read-modify-write.
+    template< typename Reg >
+    void writeFields(fieldUpdate< Reg > update){
+        writeRegister(Reg::address, update.whole() ? update.value : update.applyTo(readRegister(Reg::address)));
+    }
 
-    void clearBitMask(uint8_t regAddress, uint8_t mask);
+    /// @brief Read one field of a register.
+    template< typename Field >
+    uint8_t readField(){
+        return Field::from(readRegister(Field::inRegister::address));
+    }
 
 //################################################################################################################
 
@@ -189,6 +313,10 @@ public:
 
     void softReset();
 
+    void powerDown();
+
+    void powerUp();
+
     uint8_t checkError();
 
 //################################################################################################################
@@ -202,33 +330,69 @@ public:
    
     void initialize();
 
+    void configure();
+
+    bool isConfigured();
+
+    bool fastInitialize();
+
+    void resume();
+
     bool selfTest();
 
-    uint8_t communicate(uint8_t cmd, uint8_t sendData[], int sendDataLength, uint8_t receivedData[], int receivedDataLength);
+    void setIdleWork(idleWork * work);
+
+    void startCommand(uint8_t cmd, const cardFrame & send);
+
+    uint8_t commandStatus(uint8_t cmd);
+
+    uint8_t finishCommand(cardFrame & received);
+
+    uint8_t communicate(uint8_t cmd, const cardFrame & send, cardFrame & received);
+
+    uint8_t communicate(uint8_t cmd, const cardFrame & send);
 
     bool isCardPresented();
 
+    void startRequest();
+
+    uint8_t requestStatus();
+
+    uint8_t wakeUpCard();
+
+    void resetField();
+
     bool cardCheck();
 
     uint8_t getUID(uint8_t uid[5]);
 
+    bool pollUID(uint8_t UID[5]);
+
+    bool pollUID(uint8_t UID[5], tickSource & clock, uint32_t & latched);
+
     void waitForUID(uint8_t UID[5]);
 
+    void waitForUID(uint8_t UID[5], tickSource & clock, uint32_t & latched);
+
     bool checkBCC(uint8_t UID[5]);
 
     void printUID(uint8_t UID[5]);
 
-    bool isUIDEqual(const uint8_t cardUID[5], const uint8_t checkUID[4]);
+    bool isUIDEqual(const uint8_t UID[5], const uint8_t checkUID[4]);
 
     uint8_t calculateCRC(uint8_t data[], int length, uint8_t result[]);
 
     uint8_t selectCard(uint8_t UID[4]);
 
-    uint8_t authenticateCard(uint8_t cmd, uint8_t blockAddress, uint8_t sectorKey[6], uint8_t uid[4]);
+    uint8_t authenticateCard(uint8_t cmd, uint8_t blockAddress, const uint8_t sectorKey[6], const uint8_t uid[4]);
+
+    uint8_t readBlockFromCard(uint8_t blockAddress, uint8_t data[16]);
 
-    uint8_t readBlockFromCard();
+    uint8_t writeToBlockOnCard(uint8_t blockAddress, const uint8_t data[16]);
 
-    uint8_t writeToBlockOnCard();
+    void stopCrypto();
+
+    uint8_t haltCard();
 
 
 
@@ -239,7 +403,7 @@ public:
     }
     
     void write(uint8_t sendData[], int lengte){
-        writeRegister(FIFOLevelReg, 0x80);
+        writeFields(FIFOLevel::FlushBuffer::to<1>());
         for(int i = 0; i < lengte; i++){
             writeRegister(FIFODataReg, sendData[i]);
         }
@@ -255,20 +419,24 @@ public:
     
     void write_card(uint8_t sendData[]){
         writeRegister(CommandReg, cmdIdle); //stop any active command
-        writeRegister(ComIrqReg, 0x7F); //the interrupt request bits.
+        writeFields(ComIrq::Set1::to<0>() | ComIrq::Requests::to<0x7F>()); //clear the interrupt request bits.
         
         write(sendData, 64);
         //execute command
-        writeRegister(CommandReg, 0x04);
+        writeRegister(CommandReg, cmdTransmit);
     }
     
     void read_card(){
         writeRegister(CommandReg, cmdIdle); //stop any active command
-        writeRegister(ComIrqReg, 0x7F); //the interrupt request bits.
+        writeFields(ComIrq::Set1::to<0>() | ComIrq::Requests::to<0x7F>()); //clear the interrupt request bits.
         //execute command
-        writeRegister(CommandReg, 0x08);
+        writeRegister(CommandReg, cmdReceive);
         hwlib::wait_ms(500);
-        writeRegister(CommandReg, 0x00);
+        writeRegister(CommandReg, cmdIdle);
     }
 };
+
+//the registers, commands and self test tables are all in flash, a reader is only its bus, pins and idle work
+static_assert(sizeof(MFRC522) <= 4 * sizeof(void *), "MFRC522 may not keep tables in RAM");
+
 #endif      //MFRC522_HPP
\ No newline at end of file
@@ -0,0 +1,72 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CARDFRAME_HPP
+#define CARDFRAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// Bytes sent to or received from a card
+/// @detail
+/// A view on a buffer of the caller, with the capacity of the buffer and the length that is used. Nothing is copied:
+/// MFRC522::communicate() sends the bytes straight out of the buffer and reads the answer straight into it, but never
+/// beyond the capacity. A frame can be a part of a bigger buffer, so a command and its answer can share one array.
+class cardFrame {
+private:
+    uint8_t * bytes;
+    uint8_t room;
+    uint8_t used;
+    uint8_t bits = 0;
+public:
+    /// @brief A frame on capacity bytes at bytes, of which the first length are used.
+    cardFrame(uint8_t * bytes, uint8_t capacity, uint8_t length = 0):
+        bytes( bytes ),
+        room( capacity ),
+        used( length <= capacity ? length : capacity )
+        {}
+
+    /// @brief A frame on a whole array.
+    template< size_t N >
+    cardFrame(uint8_t (&array)[N], uint8_t length = 0):
+        cardFrame( array, N, length )
+        {}
+
+    /// @brief The frame from byte offset on, with the rest of the capacity and no bytes used.
+    cardFrame from(uint8_t offset) const {
+        return offset <= room ? cardFrame(bytes + offset, room - offset) : cardFrame(bytes + room, 0);
+    }
+
+    /// @brief Set the bytes that are used, returns false and leaves the frame as it is when it does not fit.
+    /// @detail
+    /// lastBits is the amount of valid bits in the last byte, 0 when the last byte is whole.
+    bool resize(uint8_t length, uint8_t lastBits = 0){
+        if(length > room || lastBits > 7){
+            return false;
+        }
+        used = length;
+        bits = lastBits;
+        return true;
+    }
+
+    uint8_t * data() const { return bytes; }
+
+    uint8_t & operator[](uint8_t i) const { return bytes[i]; }
+
+    uint8_t capacity() const { return room; }
+
+    uint8_t length() const { return used; }
+
+    /// @brief Valid bits of the last byte, 0 when the last byte is whole.
+    uint8_t lastBits() const { return bits; }
+
+    /// @brief The length in bits.
+    uint16_t bitCount() const { return bits == 0 ? used * 8 : (used - 1) * 8 + bits; }
+};
+
+#endif //CARDFRAME_HPP
@@ -0,0 +1,123 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "cardStorage.hpp"
+
+cardStorage::cardStorage(MFRC522 & rfid, const uint8_t keys[sectors][6], uint8_t keyType):
+    rfid( rfid ),
+    keys( keys ),
+    keyType( keyType )
+    {}
+
+uint8_t cardStorage::physicalBlock(uint8_t logical){
+    if(logical < 2){    //sector 0 only has block 1 and 2 for data
+        return logical + 1;
+    }
+    uint8_t rest = logical - 2;
+    return (1 + rest / 3) * 4 + rest % 3;   //three data blocks per sector, the fourth is the trailer
+}
+
+bool cardStorage::open(const uint8_t UID[5]){
+    for(int i = 0; i < 5; i++){
+        uid[i] = UID[i];
+    }
+    authenticatedSector = 0xFF;
+    authentications = 0;
+    reads = 0;
+    writes = 0;
+    uint8_t failure = retryPolicy::classify(rfid.selectCard(uid));
+    uint8_t attempt = 0;
+    for(; failure != retryPolicy::none; attempt++){
+        uint8_t recovery = retry.next(failure, attempt);
+        if(recovery == retryPolicy::abort){
+            break;
+        }
+        //a select again is all a select needs after a broken answer, otherwise the card has to start again
+        failure = recovery == retryPolicy::retryNow ? retryPolicy::classify(rfid.selectCard(uid)) : reselect(recovery == retryPolicy::resetField);
+    }
+    retry.finish(failure, attempt);
+    opened = failure == retryPolicy::none;
+    return opened;
+}
+
+void cardStorage::close(){
+    if(opened){
+        rfid.haltCard();    //halted before the crypto stops, so the HLTA is still encrypted
+    }
+    if(authenticatedSector != 0xFF){
+        rfid.stopCrypto();
+    }
+    authenticatedSector = 0xFF;
+    opened = false;
+}
+
+uint8_t cardStorage::authenticate(uint8_t block){
+    uint8_t sector = block / 4;
+    if(sector == authenticatedSector){  //still authenticated from the previous block
+        return MFRC522::OkStatus;
+    }
+    authentications++;
+    uint8_t status = rfid.authenticateCard(keyType, block, keys[sector], uid);
+    authenticatedSector = status == MFRC522::OkStatus ? sector : 0xFF;
+    return status;
+}
+
+uint8_t cardStorage::reselect(bool resetField){
+    authenticatedSector = 0xFF;
+    rfid.stopCrypto();
+    rfid.haltCard();        //an active card goes to HALT, one that lost track goes to IDLE, the WUPA wakes both
+    if(resetField){
+        rfid.resetField();
+    }
+    uint8_t answer[5];
+    if(rfid.wakeUpCard() != MFRC522::OkStatus || rfid.getUID(answer) != MFRC522::OkStatus || !rfid.isUIDEqual(answer, uid)){
+        return retryPolicy::gone;   //the card left, or another card took its place
+    }
+    return retryPolicy::classify(rfid.selectCard(uid));
+}
+
+uint8_t cardStorage::exchange(uint8_t physical, uint8_t read[16], const uint8_t write[16]){
+    uint8_t status = authenticate(physical);
+    if(status == MFRC522::OkStatus && write != nullptr){
+        writes++;
+        status = rfid.writeToBlockOnCard(physical, write);
+    }else if(status == MFRC522::OkStatus){
+        reads++;
+        status = rfid.readBlockFromCard(physical, read);
+    }
+    return retryPolicy::classify(status);
+}
+
+bool cardStorage::transfer(uint8_t block, uint8_t read[16], const uint8_t write[16]){
+    if(!opened || block >= dataBlocks){
+        return false;
+    }
+    uint8_t physical = physicalBlock(block);
+    uint8_t failure = exchange(physical, read, write);
+    uint8_t attempt = 0;
+    for(; failure != retryPolicy::none; attempt++){
+        uint8_t recovery = retry.next(failure, attempt);
+        if(recovery == retryPolicy::abort){
+            break;
+        }
+        if(recovery != retryPolicy::retryNow){
+            failure = reselect(recovery == retryPolicy::resetField);
+            if(failure != retryPolicy::none){
+                continue;   //the next attempt decides what to do with the failed reselect
+            }
+        }
+        failure = exchange(physical, read, write);   //writing the same block twice is harmless
+    }
+    retry.finish(failure, attempt);
+    return failure == retryPolicy::none;
+}
+
+bool cardStorage::readBlock(uint8_t block, uint8_t data[16]){
+    return transfer(block, data, nullptr);
+}
+
+bool cardStorage::writeBlock(uint8_t block, const uint8_t data[16]){
+    return transfer(block, nullptr, data);
+}
@@ -0,0 +1,89 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CARDSTORAGE_HPP
+#define CARDSTORAGE_HPP
+
+#include "hwlib.hpp"
+#include "MFRC522.hpp"
+#include "punchLog.hpp"
+#include "retryPolicy.hpp"
+
+/// @file
+
+/// @brief
+/// All data blocks of a MIFARE Classic 1K card as one storage
+/// @detail
+/// A 1K card has 16 sectors of 4 blocks. Block 0 holds the manufacturer data and the last block of every sector is the sector trailer with the keys.
+/// The other 47 blocks (752 bytes) are numbered 0 to 46 in card order: logical block 0 is block 1, logical block 2 is block 4, and so on.
+/// Every sector has its own key from the key table. A sector is only authenticated when a block in another sector is used,
+/// so reading the blocks in order authenticates every sector once.
+/// A select, read or write that fails is recovered as the retryPolicy says: asked again, or after selecting the card
+/// again with a WUPA, or after switching the field off and on. The authentication is redone after a reselect.
+class cardStorage : public blockStorage {
+private:
+    MFRC522 & rfid;
+    const uint8_t (*keys)[6];
+    uint8_t keyType;
+    uint8_t uid[5] = {0};
+    bool opened = false;
+    uint8_t authenticatedSector = 0xFF;  ///< Sector of the current authentication, 0xFF when there is none.
+
+    /// @brief Authenticate the sector of the physical block when needed, returns the MFRC522 status.
+    uint8_t authenticate(uint8_t block);
+
+    /// @brief Halt, wake and select the card again after a failure, returns the failure class.
+    uint8_t reselect(bool resetField);
+
+    /// @brief One read (into read) or write (from write) of a physical block with its authentication, returns the failure class.
+    uint8_t exchange(uint8_t physical, uint8_t read[16], const uint8_t write[16]);
+
+    /// @brief A read or write with the recoveries of the policy.
+    bool transfer(uint8_t block, uint8_t read[16], const uint8_t write[16]);
+public:
+    const static uint8_t sectors        = 16;   /// @brief Sectors on a 1K card.
+    const static uint8_t dataBlocks     = 47;   /// @brief Blocks that can be used for data.
+
+    /// @brief Amount of authentications since open, to see what a card exchange costs.
+    uint16_t authentications = 0;
+    /// @brief Amount of block reads since open.
+    uint16_t reads = 0;
+    /// @brief Amount of block writes since open.
+    uint16_t writes = 0;
+    /// @brief Recoveries of failed exchanges and their statistics, of all cards.
+    retryPolicy retry;
+
+    /// @brief Constructor
+    /// @param rfid The card reader.
+    /// @param keys Table with the key of every sector.
+    /// @param keyType MFRC522::mifareAuthKeyA or MFRC522::mifareAuthKeyB.
+    cardStorage(MFRC522 & rfid, const uint8_t keys[sectors][6], uint8_t keyType = MFRC522::mifareAuthKeyA);
+
+    /// @brief Physical block address of a logical block.
+    static uint8_t physicalBlock(uint8_t logical);
+
+    /// @brief Open a card.
+    /// @detail
+    /// Selects the card, the first sector is authenticated when it is used.
+    /// @param UID The UID of the card, as read by waitForUID.
+    bool open(const uint8_t UID[5]);
+
+    /// @brief Close the card.
+    /// @detail
+    /// Halts the card and ends the authentication. A halted card is not seen by pollUID again until it has left the field,
+    /// so a card that stays on the reader is not handled twice.
+    void close();
+
+    bool readBlock(uint8_t block, uint8_t data[16]) override;
+
+    bool writeBlock(uint8_t block, const uint8_t data[16]) override;
+
+    uint8_t blockCount() const override { return dataBlocks; }
+};
+
+//the keys stay in the table of main, a card storage is its reader, the open card and the retry statistics
+static_assert(sizeof(cardStorage) <= 3 * sizeof(void *) + sizeof(retryPolicy) + 24, "cardStorage may not copy the keys into RAM");
+
+#endif //CARDSTORAGE_HPP
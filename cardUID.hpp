@@ -0,0 +1,69 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CARDUID_HPP
+#define CARDUID_HPP
+
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// 4 byte UID of a MIFARE Classic card
+/// @detail
+/// A value type for the UID, it can be compared, hashed and used in constexpr tables. The BCC byte that MFRC522::getUID
+/// puts after the UID is not part of it.
+class cardUID {
+private:
+    uint8_t bytes[4];
+public:
+    /// @brief An all zero UID.
+    constexpr cardUID():
+        bytes{0, 0, 0, 0}
+        {}
+
+    /// @brief UID from its 4 bytes, in the order the card sends them.
+    constexpr cardUID(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3):
+        bytes{b0, b1, b2, b3}
+        {}
+
+    /// @brief UID from the first 4 bytes of a buffer, for example the UID[5] of MFRC522::getUID.
+    constexpr explicit cardUID(const uint8_t UID[4]):
+        bytes{UID[0], UID[1], UID[2], UID[3]}
+        {}
+
+    /// @brief Byte i of the UID.
+    constexpr uint8_t operator[](uint8_t i) const { return bytes[i]; }
+
+    /// @brief Pointer to the 4 bytes, for the functions of MFRC522.
+    constexpr const uint8_t * data() const { return bytes; }
+
+    /// @brief The UID as a number, the first byte is the lowest.
+    constexpr uint32_t value() const {
+        return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+    }
+
+    /// @brief The BCC the card sends after the UID.
+    constexpr uint8_t bcc() const { return bytes[0] ^ bytes[1] ^ bytes[2] ^ bytes[3]; }
+
+    /// @brief Hash of the UID with a seed, every bit of the result depends on every bit of the UID.
+    constexpr uint32_t hash(uint32_t seed = 0) const { return mix(value() ^ (seed * 0x9E3779B9u)); }
+
+    /// @brief Finalizer of MurmurHash3.
+    static constexpr uint32_t mix(uint32_t v){
+        v ^= v >> 16;
+        v *= 0x85EBCA6Bu;
+        v ^= v >> 13;
+        v *= 0xC2B2AE35u;
+        v ^= v >> 16;
+        return v;
+    }
+
+    constexpr bool operator==(const cardUID & other) const { return value() == other.value(); }
+
+    constexpr bool operator!=(const cardUID & other) const { return value() != other.value(); }
+};
+
+#endif //CARDUID_HPP
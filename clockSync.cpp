@@ -0,0 +1,105 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "clockSync.hpp"
+
+static void putWord(uint8_t data[], uint32_t word){     //stores a 32 bit word little endian
+    for(int i = 0; i < 4; i++){
+        data[i] = (word >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t getWord(const uint8_t data[]){      //reads a little endian 32 bit word
+    uint32_t word = 0;
+    for(int i = 3; i >= 0; i--){
+        word = (word << 8) | data[i];
+    }
+    return word;
+}
+
+static uint8_t checksum(const uint8_t data[], int length){     //xor of all the bytes
+    uint8_t sum = 0;
+    for(int i = 0; i < length; i++){
+        sum ^= data[i];
+    }
+    return sum;
+}
+
+void clockSync::makeSyncBlock(uint32_t reference, uint8_t block[16]){
+    for(int i = 0; i < 16; i++){
+        block[i] = 0x00;
+    }
+    block[0] = syncMagic;
+    block[1] = syncVersion;
+    putWord(&block[2], reference);
+    block[15] = checksum(block, 15);
+}
+
+bool clockSync::isSyncBlock(const uint8_t block[16]){
+    return block[0] == syncMagic && block[1] == syncVersion && block[15] == checksum(block, 15);
+}
+
+bool clockSync::applySync(const uint8_t block[16], uint32_t localTime){
+    if(!isSyncBlock(block)){
+        return false;
+    }
+    int32_t measured = int32_t(getWord(&block[2]) - localTime);
+    if(!synced || localTime < localAnchor){     //first sync, or the local clock has been set back
+        localAnchor = localTime;
+        offsetAnchor = measured;
+        drift = 0;
+    }else if(localTime - localAnchor >= minDriftInterval){  //long enough apart to see the drift through the whole seconds
+        int64_t rate = (int64_t(measured) - offsetAnchor) * 1000000000 / int64_t(localTime - localAnchor);
+        if(rate <= maxDrift && rate >= -maxDrift){  //more is a wrong sync card or a clock that was set, not drift
+            drift = int32_t(rate);
+        }
+    }
+    localSync = localTime;
+    offsetSync = measured;
+    synced = true;
+    return true;
+}
+
+uint32_t clockSync::correct(uint32_t localTime) const{
+    if(!synced){
+        return localTime;
+    }
+    int64_t elapsed = int64_t(localTime) - localSync;
+    int64_t driftCorrection = elapsed * drift / 1000000000;  //the drift since the latest sync
+    return uint32_t(int64_t(localTime) + offsetSync + driftCorrection);
+}
+
+void clockSync::clear(){
+    localAnchor = 0;
+    offsetAnchor = 0;
+    localSync = 0;
+    offsetSync = 0;
+    drift = 0;
+    synced = false;
+}
+
+void clockSync::save(uint8_t data[stateSize]) const{
+    data[0] = synced ? syncMagic : 0x00;
+    putWord(&data[1], localAnchor);
+    putWord(&data[5], uint32_t(offsetAnchor));
+    putWord(&data[9], localSync);
+    putWord(&data[13], uint32_t(offsetSync));
+    putWord(&data[17], uint32_t(drift));
+    data[21] = checksum(data, 21);
+}
+
+bool clockSync::load(const uint8_t data[stateSize]){
+    if(data[0] != syncMagic || data[21] != checksum(data, 21)){
+        clear();
+        return false;
+    }
+    localAnchor = getWord(&data[1]);
+    offsetAnchor = int32_t(getWord(&data[5]));
+    localSync = getWord(&data[9]);
+    offsetSync = int32_t(getWord(&data[13]));
+    drift = int32_t(getWord(&data[17]));
+    synced = true;
+    return true;
+}
@@ -0,0 +1,94 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CLOCKSYNC_HPP
+#define CLOCKSYNC_HPP
+
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// Clock offset and drift correction between stations
+/// @detail
+/// Every station has its own free running DS1307. The base station writes its reference time to a sync card
+/// (see makeSyncBlock) and every post station that reads this card stores the offset between the reference and its own clock.
+/// When the station is synced again at least minDriftInterval seconds later, the drift rate of its clock is calculated as well.
+/// Both offsets are whole seconds, and the card is read a while after it was written, so every offset is seconds off. Over a
+/// day that is some tens of ppm, about the drift of the crystal, so a shorter interval would mostly measure that error. A drift
+/// above maxDrift can't be the crystal and is not used.
+/// Punch times are corrected with correct(), the DS1307 itself is never set again so the oscillator keeps running undisturbed.
+/// The offset is accurate up to the time between writing the sync card at the base station and reading it at the post.
+/// All times are seconds since 1/1/1952 0:00:00, the format of DS1307::lezen_tijdstip.
+class clockSync {
+private:
+    uint32_t localAnchor = 0;   ///< Local time of the first sync, start of the drift measurement.
+    int32_t offsetAnchor = 0;   ///< Offset measured at localAnchor.
+    uint32_t localSync = 0;     ///< Local time of the latest sync.
+    int32_t offsetSync = 0;     ///< Offset measured at localSync.
+    int32_t drift = 0;          ///< Drift of the local clock in parts per billion, positive when the local clock runs slow.
+    bool synced = false;        ///< True when at least one sync card has been read.
+public:
+    const static uint8_t syncMagic          = 0x53;     /// @brief First byte of a sync card block ('S').
+    const static uint8_t syncVersion        = 0x01;     /// @brief Version of the sync card block.
+    const static uint8_t stateSize          = 22;       /// @brief Amount of bytes used by save and load.
+    const static uint32_t minDriftInterval  = 86400;    /// @brief Minimum seconds between two syncs before the drift is calculated.
+    const static int32_t maxDrift           = 100000;   /// @brief Largest drift in ppb that is believed, 100 ppm.
+
+    /// @brief Make a sync block.
+    /// @detail
+    /// Fills a 16 byte card block with the reference time of the base station.
+    /// @param reference The time of the base station.
+    /// @param block The block that gets written to the sync card.
+    static void makeSyncBlock(uint32_t reference, uint8_t block[16]);
+
+    /// @brief Check for a sync block.
+    /// @detail
+    /// Returns true when the block is a valid sync card block.
+    /// @param block The block read from the card.
+    static bool isSyncBlock(const uint8_t block[16]);
+
+    /// @brief Apply a sync card.
+    /// @detail
+    /// Stores the offset between the reference time on the card and the local time.
+    /// The drift gets (re)calculated when the first sync is at least minDriftInterval seconds ago, a drift above maxDrift
+    /// is ignored and the drift of before is kept.
+    /// Returns false when the block is not a sync block.
+    /// @param block The block read from the sync card.
+    /// @param localTime The local time at the moment the card was read.
+    bool applySync(const uint8_t block[16], uint32_t localTime);
+
+    /// @brief Correct a local time.
+    /// @detail
+    /// Returns the local time corrected for the offset and drift. Without a sync the time is returned unchanged.
+    /// @param localTime The time of the local DS1307.
+    uint32_t correct(uint32_t localTime) const;
+
+    /// @brief Forget all syncs.
+    void clear();
+
+    /// @brief Is the station synced.
+    bool isSynced() const { return synced; }
+
+    /// @brief Offset in seconds measured at the latest sync.
+    int32_t offset() const { return offsetSync; }
+
+    /// @brief Drift of the local clock in parts per billion.
+    int32_t driftPpb() const { return drift; }
+
+    /// @brief Save the state.
+    /// @detail
+    /// Writes the state to stateSize bytes, so it can be kept in the battery backed RAM of the DS1307.
+    /// @param data The array to write the state to.
+    void save(uint8_t data[stateSize]) const;
+
+    /// @brief Load the state.
+    /// @detail
+    /// Reads a state written by save. Returns false and clears the state when the data is not valid.
+    /// @param data The array to read the state from.
+    bool load(const uint8_t data[stateSize]);
+};
+
+#endif //CLOCKSYNC_HPP
@@ -0,0 +1,22 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DEELNEMERS_HPP
+#define DEELNEMERS_HPP
+
+#include "runnerRegistry.hpp"
+
+/// @file
+/// De bekende kaarten met hun loper, per wedstrijd te vervangen door een lijst uit de inschrijving.
+/// De perfecte hash wordt tijdens het compileren gemaakt, opzoeken kost op het station altijd even veel tijd.
+
+constexpr runner deelnemer_lijst[] = {
+    {cardUID(0xD0, 0x3F, 0x7B, 0xA6), 1, "David Hulsebosch", "H21"},
+};
+
+constexpr perfectRegistry<sizeof(deelnemer_lijst) / sizeof(deelnemer_lijst[0])> deelnemers(deelnemer_lijst);
+static_assert(deelnemers.ok(), "dubbele kaart in de deelnemerslijst");
+
+#endif //DEELNEMERS_HPP
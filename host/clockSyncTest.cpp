@@ -0,0 +1,67 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// clockSync with sync cards a day apart: the corrected times, a drift that can't be the crystal, and the saved state.
+// usage: clockSyncTest, returns 1 when a check fails
+
+#include "clockSync.hpp"
+#include <cstdio>
+
+const uint32_t local = 2000000000;     //local time of the first sync
+
+//reads a sync card written at reference when the local clock says localTime
+static bool sync(clockSync & clock, uint32_t reference, uint32_t localTime){
+    uint8_t block[16];
+    clockSync::makeSyncBlock(reference, block);
+    return clock.applySync(block, localTime);
+}
+
+static int failures = 0;
+
+static void check(const char * name, bool ok){
+    std::printf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    if(!ok){
+        failures++;
+    }
+}
+
+int main(){
+    clockSync clock;
+    check("not synced", !clock.isSynced() && clock.correct(local) == local);
+    uint8_t block[16];
+    clockSync::makeSyncBlock(local, block);
+    block[5] ^= 0x01;
+    check("broken sync block ignored", !clock.applySync(block, local) && !clock.isSynced());
+
+    sync(clock, local + 100, local);
+    check("first sync offset", clock.offset() == 100 && clock.driftPpb() == 0 && clock.correct(local + 3600) == local + 3700);
+
+    sync(clock, local + 86399 + 104, local + 86399);
+    check("no drift within a day", clock.offset() == 104 && clock.driftPpb() == 0);
+
+    //the local clock lost 5 s in 100000 s: 50 ppm slow
+    sync(clock, local + 100000 + 105, local + 100000);
+    check("drift after a day", clock.driftPpb() == 50000);
+    check("corrected with the drift", clock.correct(local + 300000) == local + 300000 + 105 + 10);
+    check("corrected before the sync", clock.correct(local + 80000) == local + 80000 + 105 - 1);
+
+    //20 s in 100000 s is 200 ppm, a wrong card or a clock that was set
+    clockSync other;
+    sync(other, local + 100, local);
+    sync(other, local + 100000 + 120, local + 100000);
+    check("drift above maxDrift ignored", other.driftPpb() == 0 && other.offset() == 120);
+    sync(clock, local + 200000 + 130, local + 200000);
+    check("earlier drift kept", clock.driftPpb() == 50000 && clock.offset() == 130);
+
+    uint8_t state[clockSync::stateSize];
+    clock.save(state);
+    clockSync loaded;
+    check("state loaded", loaded.load(state) && loaded.isSynced() && loaded.offset() == clock.offset() &&
+                          loaded.driftPpb() == clock.driftPpb() && loaded.correct(local + 400000) == clock.correct(local + 400000));
+    state[9] ^= 0x01;
+    check("broken state cleared", !loaded.load(state) && !loaded.isSynced() && loaded.correct(local) == local);
+
+    return failures == 0 ? 0 : 1;
+}
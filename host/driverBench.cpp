@@ -0,0 +1,219 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Microbenchmarks of the driver hot paths.
+// usage: driverBench [-t] [-s scale]
+// The pure logic (BCD, BCC, UID compare, register address bytes, punch records) is timed on the pc. The MFRC522 command
+// sequences run against the simulated MFRC522 and card in sim/, which count every SPI transaction and keep the virtual
+// time of the Due, so "bus us" is what the sequence costs on the station.
+// -t prints tab separated lines, to diff between firmware versions: transactions, bytes and bus us only change when the
+// drivers change, ns/op is the pc and moves a little from run to run. -s multiplies the amount of iterations.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include "sim/simWorld.hpp"
+#include "sim/simMFRC522.hpp"
+#include "sim/busTrace.hpp"
+#include "MFRC522.hpp"
+#include "DS1307.hpp"
+#include "cardStorage.hpp"
+#include "punchCodec.hpp"
+#include "punchLog.hpp"
+#include "memoryCard.hpp"
+
+using hwlib::target::pins;
+
+const uint8_t sleutels[cardStorage::sectors][6] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
+};
+
+//keeps the compiler from throwing away a result that is never used
+volatile uint32_t sink;
+
+static void keep(uint32_t value){
+    sink = value;
+}
+
+//counts the transactions while a sequence runs, only what the sequence itself does
+class busCounter : public sim::busObserver {
+public:
+    bool counting = false;
+    sim::busCounts counts;
+
+    void transaction(uint8_t kind, uint8_t, const uint8_t[], size_t n, uint64_t) override {
+        if(counting){
+            counts.add(kind, n);
+        }
+    }
+};
+
+struct result {
+    const char * name;
+    double ns;
+    double transactions;
+    double bytes;
+    double busUs;
+};
+
+static std::vector< result > results;
+
+static double nsSince(std::chrono::steady_clock::time_point begin){
+    return std::chrono::duration< double, std::nano >(std::chrono::steady_clock::now() - begin).count();
+}
+
+//pure logic, timed as one loop
+static void logic(const char * name, uint32_t iterations, const std::function< uint32_t(uint32_t) > & body){
+    uint32_t total = 0;
+    for(uint32_t i = 0; i < iterations / 10; i++){      //warm up
+        total += body(i);
+    }
+    auto begin = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < iterations; i++){
+        total += body(i);
+    }
+    double ns = nsSince(begin);
+    keep(total);
+    results.push_back({name, ns / iterations, 0, 0, 0});
+}
+
+//a bus sequence: prepare brings the chip and card in the right state, only op is timed and counted
+static void sequence(const char * name, uint32_t iterations, busCounter & counter,
+                     const std::function< void() > & prepare, const std::function< void() > & op){
+    sim::world & due = sim::world::current();
+    double ns = 0;
+    uint64_t virtualNs = 0;
+    counter.counts = sim::busCounts();
+    for(uint32_t i = 0; i < iterations; i++){
+        prepare();
+        uint64_t start = due.now();
+        counter.counting = true;
+        auto begin = std::chrono::steady_clock::now();
+        op();
+        ns += nsSince(begin);
+        counter.counting = false;
+        virtualNs += due.now() - start;
+    }
+    const sim::busCounts & c = counter.counts;
+    results.push_back({name, ns / iterations, double(c.spiTransactions + c.i2cTransactions) / iterations,
+                       double(c.spiBytes + c.i2cBytes) / iterations, double(virtualNs) / iterations / 1000});
+}
+
+int main(int argc, char ** argv){
+    bool table = false;
+    double scale = 1;
+    for(int arg = 1; arg < argc; arg++){
+        if(std::strcmp(argv[arg], "-t") == 0){
+            table = true;
+        }else if(std::strcmp(argv[arg], "-s") == 0 && arg + 1 < argc){
+            scale = std::atof(argv[++arg]);
+        }else{
+            std::fprintf(stderr, "usage: %s [-t] [-s scale]\n", argv[0]);
+            return 1;
+        }
+    }
+    const uint32_t pure = uint32_t(20000000 * scale) + 1;
+    const uint32_t bus = uint32_t(200 * scale) + 1;
+
+    sim::world & due = sim::world::current();
+    busCounter counter;
+    due.watch(&counter);
+    sim::card card(cardUID(0x04, 0x5A, 0x21, 0x9C));
+    sim::chip chip(due, pins::d8, pins::d12);
+
+    auto miso = hwlib::target::pin_in(pins::d11);
+    auto sclk = hwlib::target::pin_out(pins::d9);
+    auto ss = hwlib::target::pin_out(pins::d8);
+    auto mosi = hwlib::target::pin_out(pins::d10);
+    auto reset = hwlib::target::pin_out(pins::d12);
+    spiSetup spibus(sclk, mosi, miso);
+    MFRC522 rfid(spibus, ss, reset);
+    cardStorage kaart(rfid, sleutels);
+
+    //pure logic
+    logic("dec2bcd", pure, [](uint32_t i){ return DS1307::dec2bcd(i % 100); });
+    logic("bcd2dec", pure, [](uint32_t i){ return DS1307::bcd2dec(uint8_t(i) & 0x99); });
+    uint8_t UID[5] = {0x04, 0x5A, 0x21, 0x9C, 0x04 ^ 0x5A ^ 0x21 ^ 0x9C};
+    logic("checkBCC", pure, [&](uint32_t i){ UID[0] = uint8_t(i) | 1; UID[4] = UID[0] ^ 0x5A ^ 0x21 ^ 0x9C; return rfid.checkBCC(UID); });
+    const uint8_t other[4] = {0x04, 0x5A, 0x21, 0x9C};
+    logic("isUIDEqual", pure, [&](uint32_t i){ UID[3] = uint8_t(i); return rfid.isUIDEqual(UID, other); });
+    uint8_t record[punchCodec::worstCaseRecordSize()];
+    logic("punch record", pure, [&](uint32_t i){ return punchCodec::encode(uint8_t(i) | 1, int32_t(i % 7200) - 60, record) + record[1]; });
+    memoryCard memory;
+    punchLog slots(memory);
+    slots.start(0);
+    logic("punch slot", pure / 20, [&](uint32_t i){
+        if(slots.count() == 255 || slots.freeBytes() < punchCodec::worstCaseRecordSize()){
+            slots.start(0);
+        }
+        return slots.append({uint8_t(i | 1), 120 * (slots.count() + 1u), 0});
+    });
+
+    //the MFRC522 command sequences
+    const uint8_t key[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t block[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    uint8_t crc[2];
+    auto nothing = []{};
+    auto fresh = [&]{      //a card that was just put on the reader
+        rfid.stopCrypto();
+        chip.place(nullptr);
+        chip.place(&card);
+        hwlib::wait_ms(3);
+    };
+    auto detected = [&]{ fresh(); rfid.pollUID(UID); };
+    auto selected = [&]{ detected(); rfid.selectCard(UID); };
+    auto authenticated = [&]{ selected(); rfid.authenticateCard(MFRC522::mifareAuthKeyA, 4, key, UID); };
+
+    sequence("initialize", bus, counter, nothing, [&]{ rfid.initialize(); });
+    sequence("fastInitialize", bus, counter, nothing, [&]{ rfid.fastInitialize(); });
+    //the address bytes are made inside the register reads, so they are measured with their bus transaction
+    const uint8_t status[3] = {MFRC522::ComIrqReg, MFRC522::ErrorReg, MFRC522::FIFOLevelReg};
+    uint8_t values[3];
+    sequence("getByteFromRegister", bus, counter, nothing, [&]{ spibus.getByteFromRegister(MFRC522::VersionReg, ss); });
+    sequence("3 registers at once", bus, counter, nothing, [&]{ spibus.getBytesFromRegisters(status, values, 3, ss); });
+    hwlib::wait_ms(3);
+    sequence("calculateCRC 16", bus, counter, nothing, [&]{ rfid.calculateCRC(block, 16, crc); });
+    sequence("pollUID no card", bus, counter, [&]{ chip.place(nullptr); }, [&]{ rfid.pollUID(UID); });
+    sequence("pollUID", bus, counter, fresh, [&]{ rfid.pollUID(UID); });
+    sequence("selectCard", bus, counter, detected, [&]{ rfid.selectCard(UID); });
+    sequence("authenticateCard", bus, counter, selected, [&]{ rfid.authenticateCard(MFRC522::mifareAuthKeyA, 4, key, UID); });
+    sequence("readBlockFromCard", bus, counter, authenticated, [&]{ rfid.readBlockFromCard(4, block); });
+    sequence("writeToBlockOnCard", bus, counter, authenticated, [&]{ rfid.writeToBlockOnCard(4, block); });
+    sequence("haltCard", bus, counter, selected, [&]{ rfid.haltCard(); });
+    sequence("card exchange", bus, counter, fresh, [&]{     //what a punch asks of the drivers
+        rfid.pollUID(UID);
+        kaart.open(UID);
+        kaart.readBlock(0, block);
+        kaart.writeBlock(1, block);
+        kaart.close();
+    });
+    due.watch(nullptr);
+
+    if(table){
+        std::printf("benchmark\tns/op\ttransactions/op\tbytes/op\tbus us/op\n");
+        for(auto & r : results){
+            std::printf("%s\t%.2f\t%.2f\t%.2f\t%.1f\n", r.name, r.ns, r.transactions, r.bytes, r.busUs);
+        }
+        return 0;
+    }
+    std::printf("%-20s %12s %16s %10s %12s\n", "benchmark", "ns/op", "transactions/op", "bytes/op", "bus us/op");
+    for(auto & r : results){
+        if(r.transactions == 0){
+            std::printf("%-20s %12.2f %16s %10s %12s\n", r.name, r.ns, "-", "-", "-");
+        }else{
+            std::printf("%-20s %12.0f %16.1f %10.1f %12.1f\n", r.name, r.ns, r.transactions, r.bytes, r.busUs);
+        }
+    }
+    return 0;
+}
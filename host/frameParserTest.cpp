@@ -0,0 +1,99 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// frameParser on streams with broken frames: every good frame after a broken one has to be found.
+// usage: frameParserTest, returns 1 when a check fails
+
+#include "readoutFrame.hpp"
+#include <cstdio>
+#include <vector>
+
+struct byteVector : byteSink {
+    std::vector<uint8_t> bytes;
+    void put(uint8_t byte) override { bytes.push_back(byte); }
+};
+
+//a punch frame of station, the UID has a 0xA5 in it, like any byte of a frame can have
+static std::vector<uint8_t> punchFrame(uint8_t station){
+    byteVector out;
+    frameWriter frame(out);
+    frame.begin(readoutFrame::punchType, cardUID(0x12, 0xA5, 0x34, station), readoutFrame::punchFrameSize);
+    frame.addPunch({station, 1000u + station, 0});
+    frame.add(0);
+    frame.end();
+    return out.bytes;
+}
+
+static void append(std::vector<uint8_t> & stream, const std::vector<uint8_t> & bytes){
+    stream.insert(stream.end(), bytes.begin(), bytes.end());
+}
+
+//the stations of the punch frames the parser finds in the stream
+static std::vector<uint8_t> parse(const std::vector<uint8_t> & stream, uint32_t & badFrames){
+    frameParser parser;
+    std::vector<uint8_t> stations;
+    punchRecord punch;
+    uint8_t status;
+    for(uint8_t byte : stream){
+        for(bool frame = parser.feed(byte); frame; frame = parser.next()){
+            if(parser.journalPunch(punch, status)){
+                stations.push_back(punch.station);
+            }
+        }
+    }
+    while(parser.end()){
+        if(parser.journalPunch(punch, status)){
+            stations.push_back(punch.station);
+        }
+    }
+    badFrames = parser.badFrames;
+    return stations;
+}
+
+static int failures = 0;
+
+static void check(const char * name, const std::vector<uint8_t> & stream, const std::vector<uint8_t> & expected, uint32_t expectedBad){
+    uint32_t badFrames = 0;
+    std::vector<uint8_t> found = parse(stream, badFrames);
+    bool ok = found == expected && badFrames == expectedBad;
+    std::printf("%-24s %s, %zu of %zu frames, %u bad\n", name, ok ? "ok" : "FAILED", found.size(), expected.size(), badFrames);
+    if(!ok){
+        failures++;
+    }
+}
+
+int main(){
+    std::vector<uint8_t> stream;
+    append(stream, punchFrame(1));
+    append(stream, punchFrame(2));
+    check("good frames", stream, {1, 2}, 0);
+
+    stream = punchFrame(1);
+    stream[10] ^= 0xFF;     //a byte of the payload is wrong, the CRC does not match
+    append(stream, punchFrame(2));
+    check("wrong CRC", stream, {2}, 1);
+
+    stream = punchFrame(1);
+    stream.erase(stream.begin() + 10);  //a byte got lost, the frame takes the start of the next one
+    append(stream, punchFrame(2));
+    append(stream, punchFrame(3));
+    check("lost byte", stream, {2, 3}, 1);
+
+    stream = {'P', 'o', 's', 't', 0xA5, 0xFF, 0x06};    //a start byte in text with the largest length
+    for(uint8_t station = 1; station <= 5; station++){
+        append(stream, punchFrame(station));
+    }
+    for(int i = 0; i < readoutFrame::maxLength; i++){
+        stream.push_back('.');
+    }
+    check("false start", stream, {1, 2, 3, 4, 5}, 1);
+
+    stream = {0xA5, 0xFF, 0x06};     //the same at the end of the stream, never completed
+    append(stream, punchFrame(1));
+    append(stream, punchFrame(2));
+    check("false start at the end", stream, {1, 2}, 0);
+
+    return failures == 0 ? 0 : 1;
+}
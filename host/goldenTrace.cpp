@@ -0,0 +1,265 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Golden bus traces of the driver paths a card waits for: select, punch and readout.
+// usage: goldenTrace record|check|dump <select|punch|readout> trace
+// record runs the path against the simulated MFRC522, card and DS1307 and writes every SPI and I2C transaction and the
+// result of the path to the trace. check runs the path again with the chips played back from the trace: the result has to
+// be the same and the driver may not use more transactions or bytes than in the trace. dump prints the trace.
+
+#include <cstdio>
+#include <cstring>
+#include "sim/simWorld.hpp"
+#include "sim/simMFRC522.hpp"
+#include "sim/simDS1307.hpp"
+#include "sim/busTrace.hpp"
+#include "MFRC522.hpp"
+#include "DS1307.hpp"
+#include "cardStorage.hpp"
+#include "punchPipeline.hpp"
+#include "readoutFrame.hpp"
+
+using hwlib::target::pins;
+
+const uint8_t sleutels[cardStorage::sectors][6] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
+};
+
+//what a path did, compared between the recording and the check
+class resultSink : public byteSink {
+public:
+    std::vector< uint8_t > bytes;
+
+    void put(uint8_t byte) override { bytes.push_back(byte); }
+
+    void add32(uint32_t value){
+        for(uint8_t i = 0; i < 4; i++){
+            put(uint8_t(value >> (8 * i)));
+        }
+    }
+};
+
+//the blocks the driver writes are part of the result
+class recordingStorage : public cardStorage {
+public:
+    resultSink & result;
+
+    recordingStorage(MFRC522 & rfid, resultSink & result):
+        cardStorage( rfid, sleutels ),
+        result( result )
+        {}
+
+    bool writeBlock(uint8_t block, const uint8_t data[16]) override {
+        bool written = cardStorage::writeBlock(block, data);
+        result.put(block);
+        for(uint8_t i = 0; i < 16; i++){
+            result.put(data[i]);
+        }
+        result.put(written);
+        return written;
+    }
+};
+
+//the hardware of main.cpp
+struct station {
+    hwlib::target::pin_in miso = hwlib::target::pin_in(pins::d11);
+    hwlib::target::pin_out sclk = hwlib::target::pin_out(pins::d9);
+    hwlib::target::pin_out ss = hwlib::target::pin_out(pins::d8);
+    hwlib::target::pin_out mosi = hwlib::target::pin_out(pins::d10);
+    hwlib::target::pin_out reset = hwlib::target::pin_out(pins::d12);
+    hwlib::target::pin_oc scl = hwlib::target::pin_oc(pins::scl);
+    hwlib::target::pin_oc sda = hwlib::target::pin_oc(pins::sda);
+    spiSetup spibus;
+    MFRC522 rfid;
+    hwlib::i2c_bus_bit_banged_scl_sda bus;
+    DS1307 rtc;
+    resultSink result;
+    recordingStorage kaart;
+
+    station():
+        spibus( sclk, mosi, miso ),
+        rfid( spibus, ss, reset ),
+        bus( scl, sda ),
+        rtc( bus ),
+        kaart( rfid, result )
+        {}
+
+    bool poll(uint8_t UID[5]){
+        for(uint8_t i = 0; i < 10; i++){
+            if(rfid.pollUID(UID)){
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static void selectPath(station & post){
+    post.rfid.initialize();
+    hwlib::wait_ms(5);  //the card on the reader has power by now, so the trace doesn't start with a time out
+    uint8_t UID[5] = {0};
+    post.result.put(post.poll(UID));
+    for(uint8_t byte : UID){
+        post.result.put(byte);
+    }
+    post.result.put(post.kaart.open(UID));
+    post.kaart.close();
+}
+
+static void punchPath(station & post){
+    post.rfid.initialize();
+    hwlib::wait_ms(5);  //the card on the reader has power by now, so the trace doesn't start with a time out
+    dueTickCounter teller;
+    precisionClock precisie(post.rtc, teller);
+    clockSync sync;
+    punchPipeline pijplijn(precisie, teller, sync, 31, 60000, 31000);
+    uint8_t UID[5] = {0};
+    uint8_t status = punchPipeline::NoCard;
+    for(uint8_t i = 0; i < 10 && status == punchPipeline::NoCard; i++){
+        status = pijplijn.run(post.rfid, post.kaart, UID);
+    }
+    post.result.put(status);
+    post.result.put(pijplijn.count());
+    post.result.put(pijplijn.lastPunch().station);
+    post.result.add32(pijplijn.lastPunch().seconds);
+    post.result.add32(pijplijn.lastPunch().ticks);
+}
+
+static void readoutPath(station & post){   //like uitlezen_binair in main.cpp
+    post.rfid.initialize();
+    hwlib::wait_ms(5);  //the card on the reader has power by now, so the trace doesn't start with a time out
+    uint8_t UID[5] = {0};
+    if(!post.poll(UID)){
+        post.result.put(0xFF);
+        return;
+    }
+    punchLog log(post.kaart);
+    frameWriter frame(post.result);
+    uint8_t status = post.kaart.open(UID) ? log.open() : punchLog::ReadErr;
+    if(status != punchLog::OkStatus){
+        frame.begin(readoutFrame::errorType, cardUID(UID), 1);
+        frame.add(status);
+        frame.end();
+    }else{
+        frame.begin(readoutFrame::readoutType, cardUID(UID), readoutFrame::readoutHeaderSize + log.count() * readoutFrame::punchSize);
+        frame.add32(log.startTime());
+        frame.add(log.version());
+        frame.add(log.count());
+        punchRecord punch;
+        for(uint8_t i = 0; i < log.count(); i++){
+            if(log.readNext(punch) != punchLog::OkStatus){
+                punch = {0, 0, 0};
+            }
+            frame.addPunch(punch);
+        }
+        frame.end();
+    }
+    post.kaart.close();
+}
+
+static void dump(const sim::busTrace & trace){
+    static const char * kinds[] = {"spi write", "spi read ", "i2c write", "i2c read "};
+    std::printf("result:");
+    for(uint8_t byte : trace.result){
+        std::printf(" %02X", byte);
+    }
+    std::printf("\n");
+    for(auto & record : trace.records){
+        std::printf("%10.3f ms  %s %02X:", record.time / 1000.0, kinds[record.kind & 3], record.target);
+        for(uint8_t byte : record.data){
+            std::printf(" %02X", byte);
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char ** argv){
+    if(argc != 4 || (std::strcmp(argv[1], "record") != 0 && std::strcmp(argv[1], "check") != 0 && std::strcmp(argv[1], "dump") != 0)){
+        std::fprintf(stderr, "usage: %s record|check|dump <select|punch|readout> trace\n", argv[0]);
+        return 1;
+    }
+    const bool recording = std::strcmp(argv[1], "record") == 0;
+    const char * path = argv[2];
+    void (*run)(station &) = nullptr;
+    if(std::strcmp(path, "select") == 0){
+        run = selectPath;
+    }else if(std::strcmp(path, "punch") == 0){
+        run = punchPath;
+    }else if(std::strcmp(path, "readout") == 0){
+        run = readoutPath;
+    }else{
+        std::fprintf(stderr, "unknown path %s\n", path);
+        return 1;
+    }
+
+    sim::busTrace golden;
+    if(!recording && !golden.load(argv[3])){
+        std::fprintf(stderr, "can't read the trace %s\n", argv[3]);
+        return 1;
+    }
+    if(std::strcmp(argv[1], "dump") == 0){
+        dump(golden);
+        return 0;
+    }
+
+    sim::world & due = sim::world::current();
+    sim::busTrace trace;
+    sim::traceRecorder recorder(trace);
+    due.watch(&recorder);
+
+    const uint8_t powerOn[7] = {3, 1, 6, 70, 10, 0, 0};     //1/6/2022 10:00:00
+    const uint32_t start = DS1307::tijdstip_van_datum(powerOn);
+    sim::card card(cardUID(0x04, 0x5A, 0x21, 0x9C));
+    punchLog log(card);
+    log.start(start - 1800);
+    uint8_t punches = run == readoutPath ? 12 : 3;
+    for(uint8_t i = 0; i < punches; i++){
+        log.append({uint8_t(40 + i), start - 1800 + 120 * (i + 1), 0});
+    }
+
+    if(recording){
+        sim::rtc clock(due, start);
+        sim::chip rfid(due, pins::d8, pins::d12);
+        rfid.place(&card);
+        station post;
+        run(post);
+        trace.result = post.result.bytes;
+        due.watch(nullptr);
+        if(!trace.save(argv[3])){
+            std::fprintf(stderr, "can't write %s\n", argv[3]);
+            return 1;
+        }
+    }else{
+        sim::replaySpi rfid(golden);
+        sim::replayI2c clock(golden, 0x68);
+        due.connect(pins::d8, rfid);
+        due.connect(0x68, clock);
+        station post;
+        run(post);
+        trace.result = post.result.bytes;
+        due.watch(nullptr);
+    }
+
+    sim::busCounts now = recorder.counts;
+    sim::busCounts before = recording ? now : golden.counts();
+    bool same = recording || trace.result == golden.result;
+    bool fewer = now.spiTransactions <= before.spiTransactions && now.spiBytes <= before.spiBytes &&
+                 now.i2cTransactions <= before.i2cTransactions && now.i2cBytes <= before.i2cBytes;
+    std::printf("%-8s %s, spi %u -> %u transactions, %u -> %u bytes, i2c %u -> %u transactions, %u -> %u bytes, %.1f ms\n",
+                path, same ? "same result" : "DIFFERENT RESULT",
+                before.spiTransactions, now.spiTransactions, before.spiBytes, now.spiBytes,
+                before.i2cTransactions, now.i2cTransactions, before.i2cBytes, now.i2cBytes, due.now() / 1e6);
+    if(!fewer){
+        std::printf("%-8s MORE BUS TRAFFIC than the golden trace\n", path);
+    }
+    return same && fewer ? 0 : 1;
+}
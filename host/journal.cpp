@@ -0,0 +1,281 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "journal.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+mappedFile::mappedFile(const char * path){
+    int file = open(path, O_RDONLY);
+    if(file < 0){
+        length = 1;     //not ok
+        return;
+    }
+    struct stat info;
+    if(fstat(file, &info) == 0 && info.st_size > 0){
+        void * map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if(map != MAP_FAILED){
+            start = static_cast<const uint8_t *>(map);
+            madvise(map, info.st_size, MADV_SEQUENTIAL);
+        }
+        length = info.st_size;
+    }
+    close(file);
+}
+
+mappedFile::~mappedFile(){
+    if(start != nullptr){
+        munmap(const_cast<uint8_t *>(start), length);
+    }
+}
+
+static int64_t milliseconds(const punchRecord & punch){
+    return int64_t(punch.seconds) * 1000 + ((int64_t(punch.ticks) * 1000) >> 15);
+}
+
+//the punches of one file, per station
+static void parseFile(const mappedFile & file, std::vector<journalEntry> (&stations)[256], uint32_t & badFrames){
+    std::unique_ptr<frameParser> parser(new frameParser);   //too big for the stack of a thread
+    punchRecord punch;
+    uint8_t status;
+    for(size_t i = 0; i < file.size(); i++){
+        for(bool frame = parser->feed(file.data()[i]); frame; frame = parser->next()){
+            if(parser->journalPunch(punch, status)){
+                int64_t time = milliseconds(punch);
+                stations[punch.station].push_back({time, time, parser->uid().value(), punch.station, status});
+            }
+        }
+    }
+    while(parser->end()){
+        if(parser->journalPunch(punch, status)){
+            int64_t time = milliseconds(punch);
+            stations[punch.station].push_back({time, time, parser->uid().value(), punch.station, status});
+        }
+    }
+    badFrames += parser->badFrames;
+}
+
+bool journalMerge::load(const std::vector<const char *> & paths, unsigned threads){
+    std::atomic<size_t> next(0);
+    std::atomic<bool> ok(true);
+    std::mutex lock;
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < std::max(1u, threads) && t < paths.size(); t++){
+        workers.emplace_back([&](){
+            size_t index;
+            while((index = next++) < paths.size()){
+                mappedFile file(paths[index]);
+                if(!file.ok()){
+                    std::fprintf(stderr, "%s: can't open\n", paths[index]);
+                    ok = false;
+                    continue;
+                }
+                std::vector<journalEntry> parsed[256];
+                uint32_t bad = 0;
+                parseFile(file, parsed, bad);
+                std::lock_guard<std::mutex> guard(lock);
+                badFrames += bad;
+                for(size_t s = 0; s < 256; s++){
+                    stations[s].insert(stations[s].end(), parsed[s].begin(), parsed[s].end());
+                }
+            }
+        });
+    }
+    for(std::thread & worker : workers){
+        worker.join();
+    }
+    return ok;
+}
+
+bool journalMerge::loadCorrections(const char * path){
+    std::ifstream in(path);
+    if(!in){
+        std::fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+    std::string line;
+    while(std::getline(in, line)){
+        std::istringstream words(line);
+        std::string kind;
+        if(!(words >> kind) || kind[0] == '#'){
+            continue;
+        }
+        unsigned station;
+        stationCorrection correction;
+        if(kind != "station" || !(words >> station >> correction.offset >> correction.driftPpm) || station == 0 || station > 255){
+            std::fprintf(stderr, "%s: not valid: %s\n", path, line.c_str());
+            return false;
+        }
+        correction.hasReference = bool(words >> correction.reference);
+        corrections[station] = correction;
+    }
+    return true;
+}
+
+void journalMerge::applyCorrections(unsigned threads){
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < std::max(1u, threads); t++){
+        workers.emplace_back([&](){
+            size_t s;
+            while((s = next++) < 256){
+                std::vector<journalEntry> & entries = stations[s];
+                if(entries.empty()){
+                    continue;
+                }
+                //a post sends its punches in order, unless files of one post are given in the wrong order
+                if(!std::is_sorted(entries.begin(), entries.end())){
+                    std::stable_sort(entries.begin(), entries.end());
+                }
+                const stationCorrection & correction = corrections[s];
+                int64_t reference = correction.hasReference ? correction.reference : entries.front().localTime;
+                for(journalEntry & entry : entries){
+                    entry.time = entry.localTime + correction.offset + int64_t((entry.localTime - reference) * correction.driftPpm / 1e6);
+                }
+            }
+        });
+    }
+    for(std::thread & worker : workers){
+        worker.join();
+    }
+}
+
+size_t journalMerge::size() const{
+    size_t total = 0;
+    for(const std::vector<journalEntry> & entries : stations){
+        total += entries.size();
+    }
+    return total;
+}
+
+std::vector<journalEntry> journalMerge::merge(unsigned threads) const{
+    std::vector<const std::vector<journalEntry> *> streams;
+    for(const std::vector<journalEntry> & entries : stations){
+        if(!entries.empty()){
+            streams.push_back(&entries);
+        }
+    }
+    size_t total = size();
+    std::vector<journalEntry> merged(total);
+    unsigned parts = std::max(1u, std::min<unsigned>(threads, total / 4096 + 1));
+
+    //splitters from a sample of every post, every part gets about the same amount of punches
+    std::vector<journalEntry> sample;
+    for(const std::vector<journalEntry> * stream : streams){
+        for(size_t i = 0; i < stream->size(); i += 64){
+            sample.push_back((*stream)[i]);
+        }
+    }
+    std::sort(sample.begin(), sample.end());
+    //bounds[p][s] is the first punch of post s in part p
+    std::vector<std::vector<size_t>> bounds(parts + 1, std::vector<size_t>(streams.size()));
+    for(unsigned p = 0; p <= parts; p++){
+        for(size_t s = 0; s < streams.size(); s++){
+            if(p == 0){
+                bounds[p][s] = 0;
+            }else if(p == parts){
+                bounds[p][s] = streams[s]->size();
+            }else{
+                const journalEntry & splitter = sample[sample.size() * p / parts];
+                bounds[p][s] = std::lower_bound(streams[s]->begin(), streams[s]->end(), splitter) - streams[s]->begin();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    size_t offset = 0;
+    for(unsigned p = 0; p < parts; p++){
+        workers.emplace_back([&, p, offset](){
+            //k-way merge with a heap of the next punch of every post
+            typedef std::pair<journalEntry, size_t> head;
+            auto later = [](const head & a, const head & b){ return b.first < a.first; };
+            std::priority_queue<head, std::vector<head>, decltype(later)> heap(later);
+            std::vector<size_t> position = bounds[p];
+            for(size_t s = 0; s < streams.size(); s++){
+                if(position[s] < bounds[p + 1][s]){
+                    heap.push({(*streams[s])[position[s]], s});
+                }
+            }
+            size_t out = offset;
+            while(!heap.empty()){
+                size_t s = heap.top().second;
+                merged[out++] = heap.top().first;
+                heap.pop();
+                if(++position[s] < bounds[p + 1][s]){
+                    heap.push({(*streams[s])[position[s]], s});
+                }
+            }
+        });
+        for(size_t s = 0; s < streams.size(); s++){
+            offset += bounds[p + 1][s] - bounds[p][s];
+        }
+    }
+    for(std::thread & worker : workers){
+        worker.join();
+    }
+    return merged;
+}
+
+std::vector<journalMerge::mismatch> journalMerge::crossCheck(const std::vector<cardData> & cards) const{
+    //the journal of every card and post, with a flag for the punches that were found on the card
+    std::unordered_map<uint64_t, std::vector<std::pair<const journalEntry *, bool>>> journal;
+    std::unordered_map<uint32_t, bool> readOut;
+    for(const cardData & card : cards){
+        readOut[card.uid.value()] = true;
+    }
+    for(const std::vector<journalEntry> & entries : stations){
+        for(const journalEntry & entry : entries){
+            if(readOut.count(entry.uid)){
+                journal[(uint64_t(entry.uid) << 8) | entry.station].push_back({&entry, false});
+            }
+        }
+    }
+    std::vector<mismatch> found;
+    for(const cardData & card : cards){
+        for(const punchRecord & punch : card.punches){
+            if(stations[punch.station].empty()){
+                continue;   //no journal of this post
+            }
+            int64_t time = milliseconds(punch);
+            auto entries = journal.find((uint64_t(card.uid.value()) << 8) | punch.station);
+            bool matched = false;
+            if(entries != journal.end()){
+                for(auto & entry : entries->second){
+                    if(!entry.second && entry.first->localTime - time < matchWindow && time - entry.first->localTime < matchWindow){
+                        entry.second = true;
+                        matched = true;
+                        break;
+                    }
+                }
+            }
+            if(!matched){
+                found.push_back({card.uid.value(), punch.station, time, true, punchLog::OkStatus});
+            }
+        }
+    }
+    for(const auto & item : journal){
+        for(const auto & entry : item.second){
+            if(!entry.second){
+                found.push_back({entry.first->uid, entry.first->station, entry.first->localTime, false, entry.first->status});
+            }
+        }
+    }
+    std::sort(found.begin(), found.end(), [](const mismatch & a, const mismatch & b){
+        return a.uid != b.uid ? a.uid < b.uid : a.localTime < b.localTime;
+    });
+    return found;
+}
@@ -0,0 +1,107 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "resultsEngine.hpp"
+
+/// @file
+
+/// @brief
+/// One punch of a post, from the punch frames in its serial output
+struct journalEntry {
+    int64_t time;       ///< ms since the DS1307 epoch, corrected after applyCorrections.
+    int64_t localTime;  ///< The time the post wrote on the card.
+    uint32_t uid;       ///< cardUID::value().
+    uint8_t station;
+    uint8_t status;     ///< punchLog status of writing the card.
+
+    /// @brief Order of the merged journal: time, then station, then card.
+    bool operator<(const journalEntry & other) const {
+        if(time != other.time){
+            return time < other.time;
+        }
+        return station != other.station ? station < other.station : uid < other.uid;
+    }
+};
+
+/// @brief
+/// Clock correction of one post
+/// @detail
+/// corrected = local + offset + (local - reference) * drift / 1e6, reference is the first punch of the post when it is not given.
+struct stationCorrection {
+    int64_t offset = 0;         ///< ms
+    double driftPpm = 0;
+    int64_t reference = 0;      ///< ms
+    bool hasReference = false;
+};
+
+/// @brief
+/// A file mapped in memory, read only
+class mappedFile {
+private:
+    const uint8_t * start = nullptr;
+    size_t length = 0;
+public:
+    mappedFile(const char * path);
+    ~mappedFile();
+    mappedFile(const mappedFile &) = delete;
+    mappedFile & operator=(const mappedFile &) = delete;
+
+    /// @brief False when the file could not be opened.
+    bool ok() const { return start != nullptr || length == 0; }
+    const uint8_t * data() const { return start; }
+    size_t size() const { return length; }
+};
+
+/// @brief
+/// Journals of all posts merged into one list in time order
+class journalMerge {
+public:
+    /// @brief Time difference in ms between journal and card that still counts as the same punch.
+    /// @detail The card can hold whole seconds only, see punchLog fractionBits.
+    static constexpr int64_t matchWindow = 1000;
+
+    /// @brief Punches per post, index is the station ID.
+    std::vector<journalEntry> stations[256];
+    /// @brief Corrections per post.
+    stationCorrection corrections[256];
+    /// @brief Frames with a wrong CRC in the journals.
+    uint32_t badFrames = 0;
+
+    /// @brief Read the punch frames of journal files, one thread per file up to threads.
+    bool load(const std::vector<const char *> & paths, unsigned threads);
+
+    /// @brief Read corrections, every line is: station <ID> <offset ms> <drift ppm> [reference ms]
+    bool loadCorrections(const char * path);
+
+    /// @brief Sort every post and apply its correction.
+    void applyCorrections(unsigned threads);
+
+    /// @brief Merge all posts, the list is split in threads parts that are merged at the same time.
+    std::vector<journalEntry> merge(unsigned threads) const;
+
+    /// @brief A punch that is in one place and not in the other.
+    struct mismatch {
+        uint32_t uid;
+        uint8_t station;
+        int64_t localTime;
+        bool onCard;        ///< true: on the card but not in the journal, false: in the journal but not on the card.
+        uint8_t status;     ///< punchLog status of the journal entry.
+    };
+
+    /// @brief Compare the journals with card readouts.
+    /// @detail Only posts that have a journal are checked, only cards that were read out.
+    std::vector<mismatch> crossCheck(const std::vector<cardData> & cards) const;
+
+    /// @brief Amount of punches in all journals.
+    size_t size() const;
+};
+
+#endif //JOURNAL_HPP
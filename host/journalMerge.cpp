@@ -0,0 +1,136 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Merges the journals of all posts into one list in time order.
+// usage: journalMerge [-j threads] [-c corrections] [-r readout]... [-o merged.csv] journal...
+// A journal is the captured serial output of a post, see readoutFrame::punchType. The corrections file has a line
+// "station <ID> <offset ms> <drift ppm> [reference ms]" per post that needs one. Readouts (.dump files or readout frame
+// streams of the base station) are compared with the journals, every punch that is only in one of them is printed.
+// The merged list is csv: time in s,station,uid,status
+
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "journal.hpp"
+
+static double seconds(std::chrono::steady_clock::time_point since){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static bool endsWith(const std::string & text, const std::string & end){
+    return text.size() >= end.size() && text.compare(text.size() - end.size(), end.size(), end) == 0;
+}
+
+static std::string uidOf(uint32_t value){     //journalEntry keeps cardUID::value()
+    return uidText(cardUID(value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24));
+}
+
+static bool loadReadout(const char * path, std::vector<cardData> & cards){
+    if(endsWith(path, ".dump")){
+        std::vector<rawCard> dumps;
+        if(!resultsEngine::loadDumps(path, dumps)){
+            return false;
+        }
+        for(const rawCard & dump : dumps){
+            cards.push_back(resultsEngine::decode(dump));
+        }
+        return true;
+    }
+    mappedFile file(path);
+    if(!file.ok()){
+        std::fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+    static frameParser parser;
+    cardData card;
+    for(size_t i = 0; i < file.size(); i++){
+        for(bool frame = parser.feed(file.data()[i]); frame; frame = parser.next()){
+            if(parser.type() == readoutFrame::readoutType && resultsEngine::fromFrame(parser, card)){
+                cards.push_back(card);
+            }
+        }
+    }
+    while(parser.end()){
+        if(parser.type() == readoutFrame::readoutType && resultsEngine::fromFrame(parser, card)){
+            cards.push_back(card);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char ** argv){
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    const char * correctionsPath = nullptr;
+    const char * outputPath = nullptr;
+    std::vector<const char *> readouts;
+    std::vector<const char *> journals;
+    for(int arg = 1; arg < argc; arg++){
+        bool hasValue = arg + 1 < argc;
+        if(std::strcmp(argv[arg], "-j") == 0 && hasValue){
+            threads = std::max(1, std::atoi(argv[++arg]));
+        }else if(std::strcmp(argv[arg], "-c") == 0 && hasValue){
+            correctionsPath = argv[++arg];
+        }else if(std::strcmp(argv[arg], "-r") == 0 && hasValue){
+            readouts.push_back(argv[++arg]);
+        }else if(std::strcmp(argv[arg], "-o") == 0 && hasValue){
+            outputPath = argv[++arg];
+        }else{
+            journals.push_back(argv[arg]);
+        }
+    }
+    if(journals.empty()){
+        std::fprintf(stderr, "usage: %s [-j threads] [-c corrections] [-r readout]... [-o merged.csv] journal...\n", argv[0]);
+        return 1;
+    }
+
+    static journalMerge journal;
+    auto start = std::chrono::steady_clock::now();
+    if((correctionsPath != nullptr && !journal.loadCorrections(correctionsPath)) || !journal.load(journals, threads)){
+        return 1;
+    }
+    std::fprintf(stderr, "loaded %zu punches from %zu journals in %.3f s, %" PRIu32 " bad frames\n",
+                 journal.size(), journals.size(), seconds(start), journal.badFrames);
+    start = std::chrono::steady_clock::now();
+    journal.applyCorrections(threads);
+    std::vector<journalEntry> merged = journal.merge(threads);
+    std::fprintf(stderr, "corrected and merged on %u threads in %.3f s\n", threads, seconds(start));
+
+    std::FILE * out = outputPath != nullptr ? std::fopen(outputPath, "w") : stdout;
+    if(out == nullptr){
+        std::perror(outputPath);
+        return 1;
+    }
+    for(const journalEntry & entry : merged){
+        std::fprintf(out, "%" PRId64 ".%03d,%u,%s,%u\n", entry.time / 1000, int(entry.time % 1000), entry.station,
+                     uidOf(entry.uid).c_str(), entry.status);
+    }
+    if(out != stdout){
+        std::fclose(out);
+    }
+
+    if(readouts.empty()){
+        return 0;
+    }
+    std::vector<cardData> cards;
+    for(const char * path : readouts){
+        if(!loadReadout(path, cards)){
+            return 1;
+        }
+    }
+    std::vector<journalMerge::mismatch> mismatches = journal.crossCheck(cards);
+    for(const journalMerge::mismatch & item : mismatches){
+        std::fprintf(stderr, "%s post %u at %" PRId64 ".%03d: %s",
+                     uidOf(item.uid).c_str(), item.station, item.localTime / 1000,
+                     int(item.localTime % 1000), item.onCard ? "on the card, not in the journal" : "in the journal, not on the card");
+        if(!item.onCard && item.status != punchLog::OkStatus){
+            std::fprintf(stderr, " (write failed, status %u)", item.status);
+        }
+        std::fprintf(stderr, "\n");
+    }
+    std::fprintf(stderr, "%zu cards checked, %zu punches missing\n", cards.size(), mismatches.size());
+    return mismatches.empty() ? 0 : 2;
+}
@@ -0,0 +1,46 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Sends requests to liveResults and prints the answers and updates.
+// usage: liveClient [-s socket] request...
+// Every argument is sent as one line, for example: liveClient "table A" "subscribe A"
+
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+
+int main(int argc, char ** argv){
+    const char * socketPath = "/tmp/liveResults.sock";
+    int arg = 1;
+    if(argc > 2 && std::strcmp(argv[1], "-s") == 0){
+        socketPath = argv[2];
+        arg = 3;
+    }
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    if(server < 0 || connect(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0){
+        std::perror(socketPath);
+        return 1;
+    }
+    for(; arg < argc; arg++){
+        std::string line = std::string(argv[arg]) + "\n";
+        if(write(server, line.data(), line.size()) != ssize_t(line.size())){
+            std::perror("write");
+            return 1;
+        }
+    }
+    char buffer[4096];
+    ssize_t length;
+    while((length = read(server, buffer, sizeof(buffer))) > 0){
+        std::fwrite(buffer, 1, length, stdout);
+        std::fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/sh
+# End to end test of the live results on one pc: stationSim on a pty, liveResults reading it, liveClient subscribed.
+cd "$(dirname "$0")"
+dir=$(mktemp -d)
+printf 'course A 31 32 33 34 100\n' > "$dir/event.txt"
+./stationSim -o "$dir/capture.bin" "$dir/event.txt" 600 20 > "$dir/pty" &
+sim=$!
+while [ ! -s "$dir/pty" ]; do sleep 0.1; done
+./liveResults -s "$dir/live.sock" "$dir/event.txt" "$(cat "$dir/pty")" &
+server=$!
+while [ ! -S "$dir/live.sock" ]; do sleep 0.1; done
+./liveClient -s "$dir/live.sock" "table A" "subscribe A" &
+client=$!
+wait $sim
+sleep 0.5
+echo "--- final table"
+./liveClient -s "$dir/live.sock" "table A" "quit"
+kill $client $server
+echo "--- the capture gives the same results"
+./results "$dir/event.txt" "$dir/capture.bin"
+rm -r "$dir"
@@ -0,0 +1,254 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Live results from the readout stream of the base station.
+// usage: liveResults [-s socket] event.txt input
+// The input is a serial port, a pty (see stationSim) or a capture that is replayed. Clients connect to the unix socket
+// (default /tmp/liveResults.sock) and send lines:
+//   courses              course <index> <controls> <name> ... end
+//   table <course>       row <place> <uid> <time ms> <name> ... end <sequence>
+//   subscribe [course]   ok <sequence>, after that a line for every card that is read out (of that course):
+//                        update <sequence> <course> <place> <time ms> <status> <uid> <name>
+//   quit
+// A table and the updates after its sequence number are the complete results, a client never needs a table again.
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+#include "resultsEngine.hpp"
+
+class liveServer {
+private:
+    struct client {
+        int socket;
+        std::string input;
+        std::string output;
+        bool subscribed = false;
+        size_t course = resultsEngine::noCourse;   ///< noCourse is all courses.
+    };
+
+    //a client that does not read is dropped instead of using all memory
+    const static size_t maxOutput = 1 << 20;
+
+    resultsEngine & engine;
+    int listener = -1;
+    int input = -1;
+    std::vector<client> clients;
+    frameParser parser;
+    uint32_t sequence = 0;
+
+    void request(client & who, const std::string & line);
+    void publish(const cardResult & result);
+    void readInput();
+    void readClient(client & who);
+    void writeClient(client & who);
+public:
+    liveServer(resultsEngine & engine):
+        engine( engine )
+        {}
+
+    bool listen(const char * path);
+    bool open(const char * path);
+    void run();
+};
+
+bool liveServer::listen(const char * path){
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    unlink(path);
+    if(listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, 16) != 0){
+        std::perror(path);
+        return false;
+    }
+    return true;
+}
+
+bool liveServer::open(const char * path){
+    input = ::open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if(input < 0){
+        std::perror(path);
+        return false;
+    }
+    termios settings;
+    if(tcgetattr(input, &settings) == 0){  //a serial port or pty, the frames are binary
+        cfmakeraw(&settings);
+        cfsetispeed(&settings, B115200);
+        tcsetattr(input, TCSANOW, &settings);
+    }
+    return true;
+}
+
+void liveServer::publish(const cardResult & result){
+    sequence++;
+    std::string line = "update " + std::to_string(sequence) + " " +
+        (result.course == resultsEngine::noCourse ? std::string("-") : std::to_string(result.course)) + " " +
+        std::to_string(engine.place(result.uid)) + " " + std::to_string(result.time) + " " + std::to_string(result.status) + " " +
+        uidText(result.uid) + " " + engine.runnerName(result.uid) + "\n";
+    for(client & who : clients){
+        if(who.subscribed && (who.course == resultsEngine::noCourse || who.course == result.course)){
+            who.output += line;
+        }
+    }
+}
+
+void liveServer::request(client & who, const std::string & line){
+    std::string command = line.substr(0, line.find(' '));
+    std::string argument = line.size() > command.size() ? line.substr(command.size() + 1) : "";
+    size_t course = resultsEngine::noCourse;
+    if(!argument.empty()){
+        course = engine.findCourse(argument);
+        if(course == resultsEngine::noCourse){
+            who.output += "error unknown course " + argument + "\n";
+            return;
+        }
+    }
+    if(command == "courses"){
+        for(size_t c = 0; c < engine.courses().size(); c++){
+            who.output += "course " + std::to_string(c) + " " + std::to_string(engine.courses()[c].controls.size()) + " " +
+                          engine.courses()[c].name + "\n";
+        }
+        who.output += "end\n";
+    }else if(command == "table" && course != resultsEngine::noCourse){
+        for(const cardUID & uid : engine.ranked(course)){
+            who.output += "row " + std::to_string(engine.place(uid)) + " " + uidText(uid) + " " +
+                          std::to_string(engine.result(uid)->time) + " " + engine.runnerName(uid) + "\n";
+        }
+        who.output += "end " + std::to_string(sequence) + "\n";
+    }else if(command == "subscribe"){
+        who.subscribed = true;
+        who.course = course;
+        who.output += "ok " + std::to_string(sequence) + "\n";
+    }else if(command == "quit"){
+        close(who.socket);
+        who.socket = -1;
+    }else{
+        who.output += "error unknown request\n";
+    }
+}
+
+void liveServer::readInput(){
+    uint8_t buffer[4096];
+    ssize_t length = read(input, buffer, sizeof(buffer));
+    if(length == 0 || (length < 0 && errno != EAGAIN)){
+        close(input);   //end of the replay, or the station is gone, the results stay available
+        input = -1;
+        std::fprintf(stderr, "input closed, %zu cards\n", engine.cards());
+        return;
+    }
+    cardData card;
+    for(ssize_t i = 0; i < length; i++){
+        for(bool frame = parser.feed(buffer[i]); frame; frame = parser.next()){
+            if(resultsEngine::fromFrame(parser, card)){
+                cardResult result = engine.evaluate(card);
+                engine.update(result);
+                publish(result);
+            }
+        }
+    }
+}
+
+void liveServer::readClient(client & who){
+    char buffer[1024];
+    ssize_t length = read(who.socket, buffer, sizeof(buffer));
+    if(length <= 0){
+        close(who.socket);
+        who.socket = -1;
+        return;
+    }
+    who.input.append(buffer, length);
+    size_t end;
+    while(who.socket >= 0 && (end = who.input.find('\n')) != std::string::npos){
+        std::string line = who.input.substr(0, end);
+        who.input.erase(0, end + 1);
+        if(!line.empty() && line.back() == '\r'){
+            line.pop_back();
+        }
+        request(who, line);
+    }
+}
+
+void liveServer::writeClient(client & who){
+    ssize_t length = write(who.socket, who.output.data(), who.output.size());
+    if(length < 0 && errno != EAGAIN){
+        close(who.socket);
+        who.socket = -1;
+        return;
+    }
+    who.output.erase(0, length < 0 ? 0 : length);
+}
+
+void liveServer::run(){
+    std::vector<pollfd> waiting;
+    for(;;){
+        waiting.clear();
+        waiting.push_back({listener, POLLIN, 0});
+        waiting.push_back({input, POLLIN, 0});      //a negative fd is skipped by poll
+        for(const client & who : clients){
+            waiting.push_back({who.socket, short(POLLIN | (who.output.empty() ? 0 : POLLOUT)), 0});
+        }
+        if(poll(waiting.data(), waiting.size(), -1) < 0 && errno != EINTR){
+            std::perror("poll");
+            return;
+        }
+        for(size_t i = 0; i < clients.size(); i++){
+            short events = waiting[i + 2].revents;
+            if(clients[i].socket >= 0 && (events & (POLLIN | POLLHUP | POLLERR))){
+                readClient(clients[i]);
+            }
+            if(clients[i].socket >= 0 && (events & POLLOUT)){
+                writeClient(clients[i]);
+            }
+        }
+        if(waiting[1].revents & (POLLIN | POLLHUP | POLLERR)){
+            readInput();
+        }
+        if(waiting[0].revents & POLLIN){
+            int socket = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+            if(socket >= 0){
+                clients.push_back({socket, "", "", false, resultsEngine::noCourse});
+            }
+        }
+        for(size_t i = clients.size(); i-- > 0;){
+            if(clients[i].socket >= 0 && clients[i].output.size() > maxOutput){
+                close(clients[i].socket);
+                clients[i].socket = -1;
+            }
+            if(clients[i].socket < 0){
+                clients.erase(clients.begin() + i);
+            }
+        }
+    }
+}
+
+int main(int argc, char ** argv){
+    const char * socketPath = "/tmp/liveResults.sock";
+    int arg = 1;
+    if(argc > 2 && std::strcmp(argv[1], "-s") == 0){
+        socketPath = argv[2];
+        arg = 3;
+    }
+    if(argc - arg != 2){
+        std::fprintf(stderr, "usage: %s [-s socket] event.txt input\n", argv[0]);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    static resultsEngine engine;
+    static liveServer server(engine);
+    if(!engine.loadEvent(argv[arg]) || !server.listen(socketPath) || !server.open(argv[arg + 1])){
+        return 1;
+    }
+    server.run();
+    return 1;
+}
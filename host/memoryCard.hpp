@@ -0,0 +1,44 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MEMORYCARD_HPP
+#define MEMORYCARD_HPP
+
+#include <cstring>
+#include "punchLog.hpp"
+
+/// @file
+
+/// @brief
+/// Image of the data blocks of a card in memory
+/// @detail
+/// The blocks in the order cardStorage numbers them, so a card dump can be decoded with punchLog on the pc.
+class memoryCard : public blockStorage {
+public:
+    const static uint8_t blocks = 47;       ///< Data blocks of a MIFARE Classic 1K, the same as cardStorage::dataBlocks.
+    const static uint16_t imageSize = blocks * 16;
+
+    uint8_t image[imageSize] = {0};
+
+    bool readBlock(uint8_t block, uint8_t data[16]) override {
+        if(block >= blocks){
+            return false;
+        }
+        std::memcpy(data, &image[block * 16], 16);
+        return true;
+    }
+
+    bool writeBlock(uint8_t block, const uint8_t data[16]) override {
+        if(block >= blocks){
+            return false;
+        }
+        std::memcpy(&image[block * 16], data, 16);
+        return true;
+    }
+
+    uint8_t blockCount() const override { return blocks; }
+};
+
+#endif //MEMORYCARD_HPP
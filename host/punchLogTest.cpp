@@ -0,0 +1,149 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// punchLog on a card in memory: which blocks a punch writes, and that a log opened again has all punches and nothing else.
+// Also the varints of punchCodec at the edges of their sizes.
+// usage: punchLogTest, returns 1 when a check fails
+
+#include "memoryCard.hpp"
+#include "punchCodec.hpp"
+#include <cstdio>
+#include <vector>
+
+//a card that counts the writes of the header and of the data blocks
+struct countingCard : memoryCard {
+    uint32_t headerWrites = 0;
+    uint32_t dataWrites = 0;
+
+    bool writeBlock(uint8_t block, const uint8_t data[16]) override {
+        (block == 0 ? headerWrites : dataWrites)++;
+        return memoryCard::writeBlock(block, data);
+    }
+};
+
+//the stations of the punches in the log on the card, read by a log that opens it again, 0 for a punch with a wrong time
+static std::vector<uint8_t> stations(memoryCard & card){
+    punchLog log(card);
+    std::vector<uint8_t> found;
+    if(log.open() != punchLog::OkStatus){
+        return found;
+    }
+    punchRecord punch;
+    while(log.readNext(punch) == punchLog::OkStatus){
+        found.push_back(punch.seconds == 1000u + 10 * punch.station ? punch.station : 0);
+    }
+    return found;
+}
+
+//adds the punches of stations first up to last, every punch opens the log again like a post does
+static void punch(memoryCard & card, uint8_t first, uint8_t last){
+    for(uint8_t station = first; station <= last; station++){
+        punchLog log(card);
+        log.open();
+        log.append({station, 1000u + 10 * station, 0});
+    }
+}
+
+static std::vector<uint8_t> range(uint8_t first, uint8_t last){
+    std::vector<uint8_t> result;
+    for(uint8_t station = first; station <= last; station++){
+        result.push_back(station);
+    }
+    return result;
+}
+
+static int failures = 0;
+
+static void check(const char * name, bool ok){
+    std::printf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    if(!ok){
+        failures++;
+    }
+}
+
+//a delta coded and decoded again, in the expected amount of bytes, and not decoded from a record that is cut short
+static bool roundTrip(int32_t delta, uint8_t size){
+    uint8_t record[punchCodec::worstCaseRecordSize()];
+    uint8_t station = 0;
+    int32_t decoded = 0;
+    if(punchCodec::encode(7, delta, record) != size || punchCodec::recordSize(delta) != size){
+        return false;
+    }
+    return punchCodec::decode(record, size - 1, station, decoded) == 0 &&
+           punchCodec::decode(record, size, station, decoded) == size && station == 7 && decoded == delta;
+}
+
+//the ticks of a punch read back from a version 2 log that keeps bits of them
+static bool fraction(uint8_t bits, uint16_t ticks, uint16_t expected){
+    memoryCard card;
+    punchLog log(card);
+    log.start(1000, punchLog::deltaVersion, bits);
+    log.append({1, 1005, ticks});
+    log.append({2, 1010, ticks});
+    log.open();
+    punchRecord first, second;
+    return log.readNext(first) == punchLog::OkStatus && log.readNext(second) == punchLog::OkStatus &&
+           first.seconds == 1005 && first.ticks == expected && second.seconds == 1010 && second.ticks == expected;
+}
+
+int main(){
+    check("codec 0", roundTrip(0, 2));
+    check("codec 63 and -64", roundTrip(63, 2) && roundTrip(-64, 2));
+    check("codec 64 and -65", roundTrip(64, 3) && roundTrip(-65, 3));
+    check("codec 8191 and -8192", roundTrip(8191, 3) && roundTrip(-8192, 3));
+    check("codec 8192 and -8193", roundTrip(8192, 4) && roundTrip(-8193, 4));
+    check("codec INT32_MAX and INT32_MIN", roundTrip(INT32_MAX, 6) && roundTrip(INT32_MIN, 6));
+
+
+    countingCard card;
+    punchLog log(card);
+    log.start(1000, punchLog::logVersion);
+    punch(card, 1, 7);
+    check("v1 punches opened again", stations(card) == range(1, 7));
+    check("v1 header only with a new block", card.headerWrites == 1 + 4 && card.dataWrites == 7);
+    log.open();
+    punchRecord punch5;
+    check("v1 read by index", log.read(4, punch5) == punchLog::OkStatus && punch5.station == 5 && punch5.seconds == 1050);
+    check("v1 read after the last punch", log.read(7, punch5) == punchLog::RangeErr);
+
+    log.start(1000, punchLog::logVersion);
+    check("v1 earlier log not seen", stations(card).empty());
+    punch(card, 1, 1);
+    check("v1 earlier log overwritten", stations(card) == range(1, 1));
+
+    log.start(1000, punchLog::logVersion);
+    punch(card, 1, log.capacity());
+    log.open();
+    check("v1 full card", stations(card) == range(1, log.capacity()) && log.append({1, 5000, 0}) == punchLog::FullErr);
+
+    card = countingCard();
+    log.start(1000, punchLog::deltaVersion);
+    punch(card, 1, 20);     //2 byte records, 8 in a block
+    check("v2 punches opened again", stations(card) == range(1, 20));
+    check("v2 header only with a new block", card.headerWrites == 1 + 3 && card.dataWrites == 20);
+
+    log.start(1000, punchLog::deltaVersion);
+    check("v2 earlier log not seen", stations(card).empty());
+    punch(card, 1, 3);
+    check("v2 earlier log overwritten", stations(card) == range(1, 3));
+
+    card = countingCard();
+    log.start(1000, punchLog::deltaVersion);
+    for(uint8_t station = 1; station <= 6; station++){     //100 s apart, 3 byte records: five fit in a block
+        log.open();
+        log.append({station, 1000u + 100 * station, 0});
+    }
+    log.open();
+    punchRecord sixth;
+    bool padded = card.image[16 + 15] == 0 && card.image[32] == 6;
+    check("v2 record not split over blocks", padded && log.read(5, sixth) == punchLog::OkStatus && sixth.seconds == 1600);
+    check("v2 padding costs one block", log.freeBytes() == (memoryCard::blocks - 1) * 16 - 16 - 3 && card.headerWrites == 1 + 2);
+
+    check("v2 fractionBits 0", fraction(0, 12345, 0));
+    check("v2 fractionBits 10", fraction(10, 12345, 12345 & ~31));
+    check("v2 fractionBits 15", fraction(15, 12345, 12345));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Decodes the binary readout frames of a base station, from a file, a serial port or stdin.
+// Every punch becomes one line: uid,start,station,seconds,ticks
+// Start and error frames get a line that starts with # so the output can be read as csv, just like the messages of the
+// drivers, which get their text from the list in stationLog.hpp.
+
+#include <cstdio>
+#include <cinttypes>
+#include "readoutFrame.hpp"
+#include "stationLog.hpp"
+#include "stationTrace.hpp"
+
+static const char * logFormat(uint8_t id){
+    switch(id){
+#define STATION_LOG_FORMAT(name, id, text) case id: return text;
+        STATION_LOG_MESSAGES(STATION_LOG_FORMAT)
+#undef STATION_LOG_FORMAT
+    }
+    return nullptr;
+}
+
+//id, amount of numbers, time and the numbers, see stationLog
+static void printLog(const uint8_t * p, uint16_t length){
+    auto number = [p](uint8_t at){ return uint32_t(p[at]) | (uint32_t(p[at + 1]) << 8) | (uint32_t(p[at + 2]) << 16) | (uint32_t(p[at + 3]) << 24); };
+    if(length < 6 || p[1] > stationLog::maxValues || length != 6 + 4 * p[1]){
+        std::printf("# bad log message\n");
+        return;
+    }
+    unsigned values[stationLog::maxValues] = {0};
+    for(uint8_t i = 0; i < p[1]; i++){
+        values[i] = number(6 + 4 * i);
+    }
+    std::printf("# log %.6f s ", number(2) / 1e6);
+    const char * format = logFormat(p[0]);
+    if(format == nullptr){
+        std::printf("unknown message %u", p[0]);
+        for(uint8_t i = 0; i < p[1]; i++){
+            std::printf(" %u", values[i]);
+        }
+    }else{
+        std::printf(format, values[0], values[1], values[2], values[3]);
+    }
+    std::printf("\n");
+}
+
+static void printFrame(const frameParser & frame){
+    cardUID uid = frame.uid();
+    char uidText[9];
+    std::snprintf(uidText, sizeof(uidText), "%02X%02X%02X%02X", uid[0], uid[1], uid[2], uid[3]);
+    if(frame.type() == readoutFrame::readoutType){
+        uint32_t start;
+        uint8_t version, count;
+        if(!frame.readoutHeader(start, version, count)){
+            std::printf("# %s bad readout\n", uidText);
+            return;
+        }
+        for(uint8_t i = 0; i < count; i++){
+            punchRecord punch = frame.punch(i);
+            std::printf("%s,%" PRIu32 ",%u,%" PRIu32 ",%u\n", uidText, start, punch.station, punch.seconds, punch.ticks);
+        }
+        if(count == 0){
+            std::printf("# %s start %" PRIu32 " no punches\n", uidText, start);
+        }
+    }else if(frame.type() == readoutFrame::startType && frame.payloadLength() == 4){
+        const uint8_t * p = frame.payload();
+        std::printf("# %s started %" PRIu32 "\n", uidText, uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24));
+    }else if(frame.type() == readoutFrame::errorType && frame.payloadLength() == 1){
+        std::printf("# %s error %u\n", uidText, frame.payload()[0]);
+    }else if(frame.type() == readoutFrame::logType){
+        printLog(frame.payload(), frame.payloadLength());
+    }else if(frame.type() == readoutFrame::traceType){
+        std::printf("# trace %u events, see traceExport\n", (frame.payloadLength() - 4) / stationTrace::eventSize);
+    }else{
+        std::printf("# %s unknown type %u\n", uidText, frame.type());
+    }
+}
+
+int main(int argc, char ** argv){
+    std::FILE * in = stdin;
+    if(argc > 1){
+        in = std::fopen(argv[1], "rb");
+        if(in == nullptr){
+            std::perror(argv[1]);
+            return 1;
+        }
+    }
+    static frameParser parser;
+    uint32_t frames = 0;
+    int c;
+    while((c = std::getc(in)) != EOF){
+        for(bool frame = parser.feed(uint8_t(c)); frame; frame = parser.next()){
+            printFrame(parser);
+            std::fflush(stdout);
+            frames++;
+        }
+    }
+    while(parser.end()){
+        printFrame(parser);
+        frames++;
+    }
+    std::fprintf(stderr, "%" PRIu32 " frames, %" PRIu32 " bad, %" PRIu32 " bytes of text skipped\n", frames, parser.badFrames, parser.skipped);
+    return parser.badFrames == 0 ? 0 : 2;
+}
@@ -0,0 +1,92 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// recentCards: when a card leaves the window, times that wrap around, cards left on the reader and a full probe sequence.
+// usage: recentCardsTest, returns 1 when a check fails
+
+#include "recentCards.hpp"
+#include <cstdio>
+
+const uint32_t window = 60000;
+const uint32_t hold = 30500;
+
+//the next UID after uid whose probes start at place start of a table of N places
+template< size_t N >
+static cardUID startingAt(size_t start, uint32_t & uid){
+    while((cardUID(uid, uid >> 8, uid >> 16, uid >> 24).hash() & (N - 1)) != start){
+        uid++;
+    }
+    cardUID found(uid, uid >> 8, uid >> 16, uid >> 24);
+    uid++;
+    return found;
+}
+
+static int failures = 0;
+
+static void check(const char * name, bool ok){
+    std::printf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    if(!ok){
+        failures++;
+    }
+}
+
+int main(){
+    const cardUID card(0x04, 0x5A, 0x21, 0x9C);
+    const cardUID other(0x04, 0x5A, 0x21, 0x9D);
+
+    recentCards<64> recent(window, hold);
+    check("unknown card", !recent.contains(card, 1000));
+    recent.add(card, 1000);
+    check("in the window", recent.contains(card, 1000 + window - 1) && !recent.contains(other, 1000));
+    check("window expired", !recent.contains(card, 1000 + window));
+    recent.add(card, 1000 + window);
+    check("punched again", recent.contains(card, 1000 + window));
+
+    recent.clear();
+    const uint32_t late = 0xFFFFFFFF - 100;     //hwlib::now_us() / 1000 wraps after 49 days
+    recent.add(card, late);
+    check("window over the wrap", recent.contains(card, late + 1000) && recent.contains(card, late + window - 1));
+    check("expired after the wrap", !recent.contains(card, late + window));
+
+    recent.clear();
+    recent.add(card, 0);
+    recent.held(card, 40000);       //put back to check the beep
+    check("held card suppressed", recent.contains(card, 40000 + hold - 1) && !recent.contains(card, 40000 + hold));
+    recent.held(card, 70000);       //left on the reader, seen after every sleep
+    recent.held(card, 100000);
+    check("card left on the reader", recent.contains(card, 100000 + hold - 1));
+    check("held card not in the window", !recent.contains(card, 100000 + hold) && !recent.contains(card, 200000));
+    recent.add(card, 0);
+    recent.held(other, 10);
+    check("held does not add a card", !recent.contains(other, 10));
+
+    //five cards that start their probes at the same place, only four places are looked at
+    recentCards<8> small(window, hold);
+    uint32_t uid = 1;
+    cardUID same[5];
+    for(cardUID & next : same){
+        next = startingAt<8>(3, uid);
+    }
+    for(uint32_t i = 0; i < 4; i++){
+        small.add(same[i], 1000 + 10 * i);
+    }
+    bool all = true;
+    for(uint32_t i = 0; i < 4; i++){
+        all = all && small.contains(same[i], 1100);
+    }
+    check("four cards on one probe sequence", all);
+    small.add(same[4], 1100);
+    check("oldest card overwritten", !small.contains(same[0], 1100) && small.contains(same[1], 1100) && small.contains(same[4], 1100));
+    small.held(same[1], 1200);
+    small.add(same[0], 1300);
+    check("card seen least recently lost", !small.contains(same[2], 1300) && small.contains(same[1], 1300));
+    //same[1] left the window and was not seen since, same[3] was seen before it but is still in the window
+    const uint32_t now = 1000 + window + 20;
+    small.add(same[2], now);
+    check("expired card overwritten first", small.contains(same[2], now) && small.contains(same[3], now) &&
+                                             small.contains(same[0], now) && small.contains(same[4], now));
+
+    return failures == 0 ? 0 : 1;
+}
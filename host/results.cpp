@@ -0,0 +1,97 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Results of an event from card dumps and base station readouts.
+// usage: results [-j threads] [-f] event.txt input...
+// An input ending in .dump is a file of card dumps, decoded on all cores. Anything else is a stream of readout frames:
+// a capture, a serial port or - for stdin. With -f the place of every card is printed as it comes in.
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include "resultsEngine.hpp"
+
+static bool endsWith(const std::string & text, const std::string & end){
+    return text.size() >= end.size() && text.compare(text.size() - end.size(), end.size(), end) == 0;
+}
+
+static void added(const resultsEngine & engine, const cardResult & result, bool follow){
+    if(!follow){
+        return;
+    }
+    std::string name = engine.runnerName(result.uid);
+    size_t place = engine.place(result.uid);
+    if(place > 0){
+        std::printf("%s: %zu on %s\n", name.c_str(), place, engine.courses()[result.course].name.c_str());
+    }else{
+        std::printf("%s: not ranked (%u)\n", name.c_str(), result.status);
+    }
+    std::fflush(stdout);
+}
+
+int main(int argc, char ** argv){
+    unsigned threads = std::thread::hardware_concurrency();
+    bool follow = false;
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; arg++){
+        if(std::strcmp(argv[arg], "-j") == 0 && arg + 1 < argc){
+            threads = std::atoi(argv[++arg]);
+        }else if(std::strcmp(argv[arg], "-f") == 0){
+            follow = true;
+        }else{
+            break;
+        }
+    }
+    if(argc - arg < 2){
+        std::fprintf(stderr, "usage: %s [-j threads] [-f] event.txt input...\n", argv[0]);
+        return 1;
+    }
+    resultsEngine engine;
+    if(!engine.loadEvent(argv[arg])){
+        return 1;
+    }
+    for(arg++; arg < argc; arg++){
+        std::string input = argv[arg];
+        if(endsWith(input, ".dump")){
+            std::vector<rawCard> cards;
+            if(!resultsEngine::loadDumps(input.c_str(), cards)){
+                return 1;
+            }
+            for(const cardResult & result : engine.evaluateParallel(cards, threads)){
+                engine.update(result);
+                added(engine, result, follow);
+            }
+            continue;
+        }
+        std::FILE * in = input == "-" ? stdin : std::fopen(input.c_str(), "rb");
+        if(in == nullptr){
+            std::perror(input.c_str());
+            return 1;
+        }
+        static frameParser parser;
+        cardData card;
+        auto take = [&](){
+            if(resultsEngine::fromFrame(parser, card)){
+                cardResult result = engine.evaluate(card);
+                engine.update(result);
+                added(engine, result, follow);
+            }
+        };
+        int c;
+        while((c = std::getc(in)) != EOF){
+            for(bool frame = parser.feed(uint8_t(c)); frame; frame = parser.next()){
+                take();
+            }
+        }
+        while(parser.end()){
+            take();
+        }
+        if(in != stdin){
+            std::fclose(in);
+        }
+    }
+    engine.print(stdout);
+    return 0;
+}
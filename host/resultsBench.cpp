@@ -0,0 +1,76 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Cards per second of the results engine on made up cards.
+// usage: resultsBench [cards] [threads]
+// The cards are written with punchLog like a station does, so decoding is measured with the real format.
+// Prints one line per measurement: name cards threads seconds cards/s
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cstdlib>
+#include "resultsEngine.hpp"
+
+static double seconds(std::chrono::steady_clock::time_point since){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void report(const char * name, size_t cards, unsigned threads, double time){
+    std::printf("%-10s %8zu %3u %9.4f %12.0f\n", name, cards, threads, time, cards / time);
+}
+
+int main(int argc, char ** argv){
+    size_t amount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    resultsEngine engine;
+    std::mt19937 random(1);
+    for(uint8_t c = 0; c < 8; c++){
+        std::vector<uint8_t> controls;
+        for(uint8_t i = 0; i < 10 + c * 2; i++){
+            controls.push_back(31 + random() % 60);
+        }
+        controls.push_back(100);
+        engine.addCourse("course" + std::to_string(c), controls);
+    }
+
+    std::vector<rawCard> cards(amount);
+    for(size_t n = 0; n < amount; n++){
+        uint32_t uid = random();
+        size_t courseIndex = n % engine.courses().size();
+        cards[n].uid = cardUID(uid & 0xFF, (uid >> 8) & 0xFF, (uid >> 16) & 0xFF, uid >> 24);
+        engine.addEntrant({cards[n].uid, uint16_t(n), "runner", courseIndex});
+        memoryCard card;
+        punchLog log(card);
+        uint32_t time = 1000000;
+        log.start(time, punchLog::deltaVersion, 10);
+        for(uint8_t control : engine.courses()[courseIndex].controls){
+            time += 30 + random() % 600;
+            if(random() % 50 != 0){    //now and then a control is missed
+                log.append({control, time, uint16_t(random() % 32768)});
+            }
+        }
+        std::memcpy(cards[n].image, card.image, memoryCard::imageSize);
+    }
+
+    std::printf("%-10s %8s %3s %9s %12s\n", "stage", "cards", "thr", "seconds", "cards/s");
+    std::vector<cardResult> results;
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2){
+        auto start = std::chrono::steady_clock::now();
+        results = engine.evaluateParallel(cards, threads);
+        report("decode", amount, threads, seconds(start));
+        if(threads * 2 > maxThreads && threads != maxThreads){
+            threads = maxThreads / 2;   //always measure all cores as well
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t ranked = 0;
+    for(const cardResult & result : results){
+        ranked += engine.update(result) > 0;
+    }
+    report("rank", amount, 1, seconds(start));
+    std::printf("%zu of %zu cards ranked\n", ranked, amount);
+    return 0;
+}
@@ -0,0 +1,338 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "resultsEngine.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <fstream>
+#include <thread>
+
+std::string uidText(const cardUID & uid){
+    char text[9];
+    std::snprintf(text, sizeof(text), "%02X%02X%02X%02X", uid[0], uid[1], uid[2], uid[3]);
+    return text;
+}
+
+size_t resultsEngine::addCourse(const std::string & name, const std::vector<uint8_t> & controls){
+    courseList.push_back({name, controls});
+    rankings.push_back({{}, std::vector<int64_t>(controls.size(), missing)});
+    return courseList.size() - 1;
+}
+
+size_t resultsEngine::findCourse(const std::string & name) const{
+    for(size_t i = 0; i < courseList.size(); i++){
+        if(courseList[i].name == name){
+            return i;
+        }
+    }
+    return noCourse;
+}
+
+void resultsEngine::addEntrant(const entrant & runner){
+    entrants[runner.uid.value()] = runner;
+}
+
+bool resultsEngine::loadEvent(const char * path){
+    std::ifstream in(path);
+    if(!in){
+        std::fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+    std::string line;
+    size_t number = 0;
+    while(std::getline(in, line)){
+        number++;
+        std::istringstream words(line);
+        std::string kind;
+        if(!(words >> kind) || kind[0] == '#'){
+            continue;
+        }
+        bool valid = false;
+        if(kind == "course"){
+            std::string name;
+            std::vector<uint8_t> controls;
+            unsigned control;
+            words >> name;
+            while(words >> control){
+                controls.push_back(uint8_t(control));
+                valid = control > 0 && control < 256;
+            }
+            if(valid){
+                addCourse(name, controls);
+            }
+        }else if(kind == "entrant"){
+            std::string uid, courseName, name;
+            unsigned runnerNumber;
+            if(words >> uid >> courseName >> runnerNumber && uid.size() == 8){
+                std::getline(words >> std::ws, name);
+                uint32_t value = std::strtoul(uid.c_str(), nullptr, 16);
+                cardUID card(value >> 24, (value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF);
+                size_t index = findCourse(courseName);
+                valid = index != noCourse;
+                if(valid){
+                    addEntrant({card, uint16_t(runnerNumber), name, index});
+                }
+            }
+        }
+        if(!valid){
+            std::fprintf(stderr, "%s:%zu: not valid: %s\n", path, number, line.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool resultsEngine::loadDumps(const char * path, std::vector<rawCard> & cards){
+    std::FILE * in = std::fopen(path, "rb");
+    if(in == nullptr){
+        std::perror(path);
+        return false;
+    }
+    rawCard card;
+    uint8_t uid[4];
+    while(std::fread(uid, 1, 4, in) == 4 && std::fread(card.image, 1, memoryCard::imageSize, in) == memoryCard::imageSize){
+        card.uid = cardUID(uid);
+        cards.push_back(card);
+    }
+    std::fclose(in);
+    return true;
+}
+
+bool resultsEngine::fromFrame(const frameParser & frame, cardData & card){
+    uint8_t version, count;
+    card.uid = frame.uid();
+    card.punches.clear();
+    if(frame.type() == readoutFrame::errorType){
+        card.status = frame.payload()[0];
+        return true;
+    }
+    if(!frame.readoutHeader(card.start, version, count)){
+        return false;
+    }
+    card.status = punchLog::OkStatus;
+    for(uint8_t i = 0; i < count; i++){
+        card.punches.push_back(frame.punch(i));
+        if(card.punches.back().station == 0){
+            card.status = punchLog::ReadErr;    //the station could not read this punch
+        }
+    }
+    return true;
+}
+
+cardData resultsEngine::decode(const rawCard & card){
+    memoryCard image;
+    std::memcpy(image.image, card.image, memoryCard::imageSize);
+    punchLog log(image);
+    cardData data;
+    data.uid = card.uid;
+    data.status = log.open();
+    if(data.status != punchLog::OkStatus){
+        return data;
+    }
+    data.start = log.startTime();
+    data.punches.resize(log.count());
+    for(punchRecord & punch : data.punches){
+        data.status = log.readNext(punch);
+        if(data.status != punchLog::OkStatus){
+            break;
+        }
+    }
+    return data;
+}
+
+cardResult resultsEngine::evaluate(const cardData & card) const{
+    cardResult result = {card.uid, noCourse, Ok, missing, {}};
+    auto runner = entrants.find(card.uid.value());
+    if(runner != entrants.end()){
+        result.course = runner->second.course;
+    }else if(courseList.size() == 1){
+        result.course = 0;      //with one course every card runs it
+    }
+    if(card.status != punchLog::OkStatus){
+        result.status = Unreadable;
+        return result;
+    }
+    if(result.course == noCourse){
+        result.status = NoCourse;
+        return result;
+    }
+    //the controls have to be punched in order, other punches in between are allowed
+    const std::vector<uint8_t> & controls = courseList[result.course].controls;
+    result.splits.assign(controls.size(), missing);
+    size_t next = 0;
+    int64_t previous = 0;       //time of the previous control, the start is 0
+    bool previousFound = true;
+    for(size_t leg = 0; leg < controls.size(); leg++){
+        size_t found = next;
+        while(found < card.punches.size() && card.punches[found].station != controls[leg]){
+            found++;
+        }
+        if(found == card.punches.size()){
+            result.status = MissingPunch;   //the next controls can still be found after the last punched one
+            previousFound = false;
+            continue;
+        }
+        const punchRecord & punch = card.punches[found];
+        int64_t time = (int64_t(punch.seconds) - card.start) * 1000 + ((int64_t(punch.ticks) * 1000) >> 15);
+        if(previousFound){
+            result.splits[leg] = time - previous;
+        }
+        previous = time;
+        previousFound = true;
+        next = found + 1;
+    }
+    if(result.status == Ok){
+        result.time = previous;
+    }
+    return result;
+}
+
+std::vector<cardResult> resultsEngine::evaluateParallel(const std::vector<rawCard> & cards, unsigned threads) const{
+    std::vector<cardResult> results(cards.size());
+    if(threads == 0){
+        threads = 1;
+    }
+    std::vector<std::thread> workers;
+    size_t chunk = (cards.size() + threads - 1) / threads;
+    for(unsigned t = 0; t < threads; t++){
+        size_t begin = t * chunk;
+        size_t end = std::min(cards.size(), begin + chunk);
+        if(begin >= end){
+            break;
+        }
+        workers.emplace_back([this, &cards, &results, begin, end](){
+            for(size_t i = begin; i < end; i++){
+                results[i] = evaluate(decode(cards[i]));
+            }
+        });
+    }
+    for(std::thread & worker : workers){
+        worker.join();
+    }
+    return results;
+}
+
+void resultsEngine::recomputeBest(size_t courseIndex, size_t leg){
+    int64_t best = missing;
+    for(const rankEntry & entry : rankings[courseIndex].order){
+        int64_t split = results.at(entry.uid).splits[leg];
+        if(best == missing || split < best){
+            best = split;
+        }
+    }
+    rankings[courseIndex].bestSplits[leg] = best;
+}
+
+void resultsEngine::removeRanked(const cardResult & old){
+    ranking & rank = rankings[old.course];
+    rankEntry entry = {old.time, old.uid.value()};
+    auto position = std::lower_bound(rank.order.begin(), rank.order.end(), entry);
+    rank.order.erase(position);
+}
+
+size_t resultsEngine::update(const cardResult & result){
+    auto earlier = results.find(result.uid.value());
+    std::vector<size_t> lostBest;
+    if(earlier != results.end()){
+        const cardResult & old = earlier->second;
+        if(old.status == Ok){
+            removeRanked(old);
+            for(size_t leg = 0; leg < old.splits.size(); leg++){
+                if(old.splits[leg] == rankings[old.course].bestSplits[leg]){
+                    lostBest.push_back(leg);
+                }
+            }
+        }
+        size_t oldCourse = old.course;
+        earlier->second = result;
+        for(size_t leg : lostBest){
+            recomputeBest(oldCourse, leg);
+        }
+    }else{
+        results.emplace(result.uid.value(), result);
+    }
+    if(result.status != Ok){
+        return 0;
+    }
+    ranking & rank = rankings[result.course];
+    for(size_t leg = 0; leg < result.splits.size(); leg++){
+        if(rank.bestSplits[leg] == missing || result.splits[leg] < rank.bestSplits[leg]){
+            rank.bestSplits[leg] = result.splits[leg];
+        }
+    }
+    rankEntry entry = {result.time, result.uid.value()};
+    rank.order.insert(std::upper_bound(rank.order.begin(), rank.order.end(), entry), entry);
+    return place(result.uid);
+}
+
+size_t resultsEngine::place(const cardUID & uid) const{
+    auto result = results.find(uid.value());
+    if(result == results.end() || result->second.status != Ok){
+        return 0;
+    }
+    const std::vector<rankEntry> & order = rankings[result->second.course].order;
+    //runners with the same time share a place
+    auto first = std::lower_bound(order.begin(), order.end(), rankEntry{result->second.time, 0});
+    return size_t(first - order.begin()) + 1;
+}
+
+const cardResult * resultsEngine::result(const cardUID & uid) const{
+    auto found = results.find(uid.value());
+    return found == results.end() ? nullptr : &found->second;
+}
+
+std::vector<cardUID> resultsEngine::ranked(size_t courseIndex) const{
+    std::vector<cardUID> order;
+    for(const rankEntry & entry : rankings[courseIndex].order){
+        order.push_back(results.at(entry.uid).uid);
+    }
+    return order;
+}
+
+std::string resultsEngine::runnerName(const cardUID & uid) const{
+    auto runner = entrants.find(uid.value());
+    if(runner != entrants.end()){
+        return std::to_string(runner->second.number) + " " + runner->second.name;
+    }
+    return uidText(uid);
+}
+
+static void printTime(std::FILE * out, int64_t ms){
+    if(ms == resultsEngine::missing){
+        std::fprintf(out, "%10s", "-----");
+        return;
+    }
+    std::fprintf(out, "%4lld:%02lld.%03lld", (long long)(ms / 60000), (long long)(ms / 1000 % 60), (long long)(ms % 1000));
+}
+
+void resultsEngine::print(std::FILE * out) const{
+    for(size_t c = 0; c < courseList.size(); c++){
+        const ranking & rank = rankings[c];
+        std::fprintf(out, "%s (%zu controls)\n", courseList[c].name.c_str(), courseList[c].controls.size());
+        for(const rankEntry & entry : rank.order){
+            const cardResult & result = results.at(entry.uid);
+            std::fprintf(out, "%4zu %-30s ", place(result.uid), runnerName(result.uid).c_str());
+            printTime(out, result.time);
+            for(size_t leg = 0; leg < result.splits.size(); leg++){
+                std::fprintf(out, " ");
+                printTime(out, result.splits[leg]);
+                std::fprintf(out, result.splits[leg] == rank.bestSplits[leg] ? "*" : " ");
+            }
+            std::fprintf(out, "\n");
+        }
+        for(const auto & item : results){
+            if(item.second.course == c && item.second.status != Ok){
+                std::fprintf(out, "     %-30s %s\n", runnerName(item.second.uid).c_str(),
+                             item.second.status == MissingPunch ? "mp" : "unreadable");
+            }
+        }
+    }
+    for(const auto & item : results){
+        if(item.second.course == noCourse){
+            std::fprintf(out, "no course: %s\n", runnerName(item.second.uid).c_str());
+        }
+    }
+}
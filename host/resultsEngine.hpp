@@ -0,0 +1,162 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RESULTSENGINE_HPP
+#define RESULTSENGINE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "punchLog.hpp"
+#include "cardUID.hpp"
+#include "memoryCard.hpp"
+#include "readoutFrame.hpp"
+
+/// @file
+
+/// @brief UID as 8 hex digits, in the order the card sends the bytes.
+std::string uidText(const cardUID & uid);
+
+/// @brief
+/// A course, the controls in the order they have to be punched, the last one is the finish.
+struct course {
+    std::string name;
+    std::vector<uint8_t> controls;
+};
+
+/// @brief
+/// A runner and the course of that runner
+struct entrant {
+    cardUID uid;
+    uint16_t number;
+    std::string name;
+    size_t course;
+};
+
+/// @brief
+/// What was on a card
+struct cardData {
+    cardUID uid;
+    uint32_t start = 0;
+    uint8_t status = punchLog::OkStatus;    ///< punchLog status of reading the card.
+    std::vector<punchRecord> punches;
+};
+
+/// @brief
+/// A card dump, the UID and the image of the data blocks
+struct rawCard {
+    cardUID uid;
+    uint8_t image[memoryCard::imageSize];
+};
+
+/// @brief
+/// A card checked against its course
+struct cardResult {
+    cardUID uid;
+    size_t course;
+    uint8_t status;
+    int64_t time;                   ///< Running time in ms, from the start to the finish.
+    std::vector<int64_t> splits;    ///< Time in ms of every leg, missing when a control was not punched.
+};
+
+/// @brief
+/// Results of an event, updated card by card
+/// @detail
+/// Decoding and checking a card only reads the courses and entrants, so many cards can be done at the same time on
+/// different cores. Adding a result to the ranking is done one card at a time: only the ranking of the course of that card
+/// changes, with one binary search, and the best split of a leg is only searched again when the best runner was read again.
+class resultsEngine {
+public:
+    const static uint8_t Ok             = 0x00;     /// @brief All controls in the right order.
+    const static uint8_t MissingPunch   = 0x01;     /// @brief A control or the finish is missing.
+    const static uint8_t Unreadable     = 0x02;     /// @brief The punch log could not be decoded.
+    const static uint8_t NoCourse       = 0x03;     /// @brief The card has no course.
+
+    const static size_t noCourse = size_t(-1);
+    static constexpr int64_t missing = -1;
+
+    /// @brief Add a course, returns its index.
+    size_t addCourse(const std::string & name, const std::vector<uint8_t> & controls);
+
+    /// @brief Index of a course, or noCourse.
+    size_t findCourse(const std::string & name) const;
+
+    /// @brief Add a runner, a card that is already known gets the new runner.
+    void addEntrant(const entrant & runner);
+
+    /// @brief Read courses and entrants from a file.
+    /// @detail
+    /// Every line is one of:
+    /// course <name> <control> <control> ... <finish>
+    /// entrant <UID as 8 hex digits> <course> <number> <name>
+    /// Empty lines and lines that start with # are skipped. Returns false and prints the line when a line is not valid.
+    bool loadEvent(const char * path);
+
+    /// @brief Read a file of card dumps, every dump is the UID (4 bytes) followed by the image of the data blocks.
+    static bool loadDumps(const char * path, std::vector<rawCard> & cards);
+
+    /// @brief The card of a readout frame of the base station, returns false when it is not a readout.
+    static bool fromFrame(const frameParser & frame, cardData & card);
+
+    /// @brief Decode the punch log of a card dump.
+    static cardData decode(const rawCard & card);
+
+    /// @brief Check a card against its course.
+    cardResult evaluate(const cardData & card) const;
+
+    /// @brief Decode and check many cards on threads cores.
+    std::vector<cardResult> evaluateParallel(const std::vector<rawCard> & cards, unsigned threads) const;
+
+    /// @brief Add a result, replacing an earlier result of the same card.
+    /// @detail
+    /// Returns the new place on the course, 0 when the runner is not ranked.
+    size_t update(const cardResult & result);
+
+    /// @brief Place of a card on its course, 0 when it is not ranked.
+    size_t place(const cardUID & uid) const;
+
+    /// @brief The result of a card, or nullptr when the card has no result.
+    const cardResult * result(const cardUID & uid) const;
+
+    /// @brief The ranked cards of a course, fastest first.
+    std::vector<cardUID> ranked(size_t courseIndex) const;
+
+    /// @brief Amount of cards that have a result.
+    size_t cards() const { return results.size(); }
+
+    /// @brief Print the ranking with splits of every course.
+    void print(std::FILE * out) const;
+
+    /// @brief Name of a runner, or the UID in hex when the card has no entrant.
+    std::string runnerName(const cardUID & uid) const;
+
+    const std::vector<course> & courses() const { return courseList; }
+
+private:
+    struct rankEntry {
+        int64_t time;
+        uint32_t uid;
+        bool operator<(const rankEntry & other) const {
+            return time != other.time ? time < other.time : uid < other.uid;
+        }
+    };
+
+    struct ranking {
+        std::vector<rankEntry> order;
+        std::vector<int64_t> bestSplits;
+    };
+
+    std::vector<course> courseList;
+    std::vector<ranking> rankings;
+    std::unordered_map<uint32_t, entrant> entrants;
+    std::unordered_map<uint32_t, cardResult> results;
+
+    void removeRanked(const cardResult & old);
+    void recomputeBest(size_t courseIndex, size_t leg);
+};
+
+#endif //RESULTSENGINE_HPP
@@ -0,0 +1,80 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// perfectRegistry: every runner of a list is found and a card that is not in it is not, also for 2000 runners made at
+// compile time, and a list with one card twice is refused.
+// usage: runnerRegistryTest, returns 1 when a check fails
+
+#include "runnerRegistry.hpp"
+#include <cstdio>
+
+//the UID of runner i, different for every i
+constexpr cardUID uidOf(uint32_t i){
+    uint32_t v = cardUID::mix(i + 1);
+    return cardUID(v, v >> 8, v >> 16, v >> 24);
+}
+
+template< size_t N >
+struct runnerList {
+    runner list[N] = {};
+
+    constexpr runnerList(){
+        for(size_t i = 0; i < N; i++){
+            list[i] = {uidOf(i), uint16_t(i + 1), "", ""};
+        }
+    }
+};
+
+constexpr runner small[] = {
+    {cardUID(0xD0, 0x3F, 0x7B, 0xA6), 1, "David Hulsebosch", "H21"},
+    {cardUID(0x04, 0x5A, 0x21, 0x9C), 2, "Anna", "D21"},
+    {cardUID(0x04, 0x5A, 0x21, 0x9D), 3, "Bram", "H16"},
+    {cardUID(0x9C, 0x21, 0x5A, 0x04), 4, "Carla", "D45"},
+    {cardUID(0x00, 0x00, 0x00, 0x01), 5, "Daan", "H45"},
+};
+constexpr perfectRegistry<5> smallRegistry(small);
+static_assert(smallRegistry.ok(), "the small list has no card twice");
+static_assert(smallRegistry.find(cardUID(0x04, 0x5A, 0x21, 0x9D))->number == 3, "a lookup works at compile time");
+
+constexpr runner twice[] = {
+    {cardUID(0xD0, 0x3F, 0x7B, 0xA6), 1, "David Hulsebosch", "H21"},
+    {cardUID(0x04, 0x5A, 0x21, 0x9C), 2, "Anna", "D21"},
+    {cardUID(0xD0, 0x3F, 0x7B, 0xA6), 3, "Bram", "H16"},
+};
+constexpr perfectRegistry<3> twiceRegistry(twice);
+static_assert(!twiceRegistry.ok(), "a card that is in the list twice is refused");
+
+//a big event, made by the compiler like the list of deelnemers.hpp
+constexpr runnerList<2000> big;
+constexpr perfectRegistry<2000> bigRegistry(big.list);
+static_assert(bigRegistry.ok(), "2000 runners are placed within the constexpr limits");
+
+//every runner is found with its own number, and a card that is not in the list gives nullptr
+template< size_t N >
+static bool allFound(const perfectRegistry<N> & registry, const runner (&list)[N], const cardUID & missing){
+    for(const runner & entry : list){
+        const runner * found = registry.find(entry.uid);
+        if(found == nullptr || found->number != entry.number){
+            return false;
+        }
+    }
+    return registry.find(missing) == nullptr;
+}
+
+static int failures = 0;
+
+static void check(const char * name, bool ok){
+    std::printf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    if(!ok){
+        failures++;
+    }
+}
+
+int main(){
+    check("small list", smallRegistry.ok() && allFound(smallRegistry, small, cardUID(0x04, 0x5A, 0x21, 0x9E)));
+    check("card twice refused", !twiceRegistry.ok());
+    check("2000 runners", bigRegistry.ok() && allFound(bigRegistry, big.list, uidOf(2000)));
+    return failures == 0 ? 0 : 1;
+}
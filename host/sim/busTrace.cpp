@@ -0,0 +1,156 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "busTrace.hpp"
+#include <fstream>
+#include <iterator>
+
+namespace sim {
+
+void busCounts::add(uint8_t kind, size_t n){
+    if(kind == busObserver::spiWrite || kind == busObserver::spiRead){
+        spiTransactions++;
+        spiBytes += n + 1;
+    }else{
+        i2cTransactions++;
+        i2cBytes += n + 1;
+    }
+}
+
+busCounts busTrace::counts() const {
+    busCounts total;
+    for(auto & record : records){
+        total.add(record.kind, record.data.size());
+    }
+    return total;
+}
+
+bool busTrace::save(const std::string & path) const {
+    std::string bytes = "BTRC";
+    bytes += char(version);
+    bytes += char(result.size());
+    bytes += char(result.size() >> 8);
+    bytes.append(result.begin(), result.end());
+    uint64_t previous = 0;
+    for(auto & record : records){
+        size_t n = record.data.size();
+        bytes += char(record.kind << 6 | (n < 63 ? n : 63));
+        if(n >= 63){
+            bytes += char(n);
+        }
+        bytes += char(record.target);
+        uint64_t delta = record.time - previous;
+        previous = record.time;
+        do {
+            bytes += char((delta & 0x7F) | (delta > 0x7F ? 0x80 : 0x00));
+            delta >>= 7;
+        } while(delta != 0);
+        bytes.append(record.data.begin(), record.data.end());
+    }
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), bytes.size());
+    return bool(file);
+}
+
+bool busTrace::load(const std::string & path){
+    std::ifstream file(path, std::ios::binary);
+    std::vector< uint8_t > bytes((std::istreambuf_iterator< char >(file)), std::istreambuf_iterator< char >());
+    if(bytes.size() < 7 || std::string(bytes.begin(), bytes.begin() + 4) != "BTRC" || bytes[4] != version){
+        return false;
+    }
+    size_t length = bytes[5] | (bytes[6] << 8);
+    size_t position = 7 + length;
+    if(position > bytes.size()){
+        return false;
+    }
+    result.assign(bytes.begin() + 7, bytes.begin() + position);
+    records.clear();
+    uint64_t time = 0;
+    while(position < bytes.size()){
+        traceRecord record;
+        record.kind = bytes[position] >> 6;
+        size_t n = bytes[position++] & 0x3F;
+        if(n == 63 && position < bytes.size()){
+            n = bytes[position++];
+        }
+        if(position >= bytes.size()){
+            return false;
+        }
+        record.target = bytes[position++];
+        uint64_t delta = 0;
+        for(uint8_t shift = 0; ; shift += 7){
+            if(position >= bytes.size() || shift > 63){
+                return false;
+            }
+            uint8_t byte = bytes[position++];
+            delta |= uint64_t(byte & 0x7F) << shift;
+            if(!(byte & 0x80)){
+                break;
+            }
+        }
+        time += delta;
+        record.time = time;
+        if(position + n > bytes.size()){
+            return false;
+        }
+        record.data.assign(bytes.begin() + position, bytes.begin() + position + n);
+        position += n;
+        records.push_back(record);
+    }
+    return true;
+}
+
+void traceRecorder::transaction(uint8_t kind, uint8_t target, const uint8_t data[], size_t n, uint64_t time){
+    counts.add(kind, n);
+    trace.records.push_back({kind, target, time / 1000, std::vector< uint8_t >(data, data + n)});
+}
+
+replaySpi::replaySpi(const busTrace & trace){
+    for(auto & record : trace.records){
+        if(record.kind == busObserver::spiRead){
+            values[record.target & 0x3F].insert(values[record.target & 0x3F].end(), record.data.begin(), record.data.end());
+        }
+    }
+}
+
+void replaySpi::transfer(size_t n, const uint8_t out[], uint8_t in[]){
+    if(n == 0 || !(out[0] & 0x80)){
+        return;
+    }
+    in[0] = 0x00;
+    for(size_t i = 0; i + 1 < n; i++){
+        uint8_t reg = (out[i] >> 1) & 0x3F;
+        if(!values[reg].empty()){
+            last[reg] = values[reg].front();
+            values[reg].pop_front();
+        }
+        in[i + 1] = last[reg];
+    }
+}
+
+replayI2c::replayI2c(const busTrace & trace, uint8_t address){
+    for(auto & record : trace.records){
+        if(record.kind == busObserver::i2cRead && record.target == address){
+            reads.push_back(record.data);
+        }
+    }
+}
+
+void replayI2c::begin(bool reading){
+    if(!reading){
+        return;
+    }
+    position = 0;
+    if(!reads.empty()){
+        current = reads.front();
+        reads.pop_front();
+    }
+}
+
+uint8_t replayI2c::read(){
+    return position < current.size() ? current[position++] : 0xFF;
+}
+
+}   //namespace sim
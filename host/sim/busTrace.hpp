@@ -0,0 +1,110 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BUSTRACE_HPP
+#define BUSTRACE_HPP
+
+#include "simWorld.hpp"
+#include <deque>
+#include <string>
+#include <vector>
+
+/// @file
+
+namespace sim {
+
+/// @brief One transaction on the SPI or I2C bus, see busObserver for the kinds.
+struct traceRecord {
+    uint8_t kind;
+    uint8_t target;
+    uint64_t time;      ///< us since power on.
+    std::vector< uint8_t > data;
+};
+
+/// @brief Transactions and bytes on the buses, the bytes include the address byte.
+struct busCounts {
+    uint32_t spiTransactions = 0;
+    uint32_t spiBytes = 0;
+    uint32_t i2cTransactions = 0;
+    uint32_t i2cBytes = 0;
+
+    void add(uint8_t kind, size_t n);
+};
+
+/// @brief
+/// A recorded run of the drivers
+/// @detail
+/// The functional result of the run and every bus transaction. In a file it is compact:
+/// | bytes | content |
+/// |-------|---------|
+/// | 4     | "BTRC" |
+/// | 1     | version 1 |
+/// | 2     | length of the result, little endian |
+/// | n     | the result |
+///
+/// followed by the records until the end of the file:
+/// | bytes | content |
+/// |-------|---------|
+/// | 1     | bit 6-7: kind, bit 0-5: amount of data bytes, 63 when the amount follows in the next byte |
+/// | 1     | register or I2C address |
+/// | 1-5   | us since the previous record, 7 bits per byte with the lowest first, bit 7 set when more bytes follow |
+/// | n     | the data |
+class busTrace {
+public:
+    const static uint8_t version = 1;
+
+    std::vector< uint8_t > result;
+    std::vector< traceRecord > records;
+
+    busCounts counts() const;
+    bool save(const std::string & path) const;
+    bool load(const std::string & path);
+};
+
+/// @brief Records what goes over the buses into a trace, and counts it.
+class traceRecorder : public busObserver {
+private:
+    busTrace & trace;
+public:
+    busCounts counts;
+
+    traceRecorder(busTrace & trace):
+        trace( trace )
+        {}
+
+    void transaction(uint8_t kind, uint8_t target, const uint8_t data[], size_t n, uint64_t time) override;
+};
+
+/// @brief
+/// The MFRC522 played back from a trace
+/// @detail
+/// Every register has its own queue with the values that were read from it, in the order they were read.
+/// A driver that reads a register less often, or in another order between registers, still gets the same answers.
+/// Writes are not checked here, the result of the run shows if they were right. When a queue is empty the last value repeats.
+class replaySpi : public spiDevice {
+private:
+    std::deque< uint8_t > values[64];
+    uint8_t last[64] = {};
+public:
+    replaySpi(const busTrace & trace);
+    void transfer(size_t n, const uint8_t out[], uint8_t in[]) override;
+};
+
+/// @brief An I2C chip played back from a trace, every read transaction gets the bytes of the next recorded read.
+class replayI2c : public i2cDevice {
+private:
+    std::deque< std::vector< uint8_t > > reads;
+    std::vector< uint8_t > current;
+    size_t position = 0;
+public:
+    replayI2c(const busTrace & trace, uint8_t address);
+    void begin(bool reading) override;
+    void write(uint8_t) override {}
+    uint8_t read() override;
+};
+
+}   //namespace sim
+
+#endif //BUSTRACE_HPP
@@ -0,0 +1,204 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIM_HWLIB_HPP
+#define SIM_HWLIB_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/// @file
+
+/// @brief
+/// The part of hwlib the station uses, for a simulated Arduino Due on the pc
+/// @detail
+/// Time is virtual: it only moves when the firmware waits, reads the time or uses a pin or bus, by the amount that takes
+/// on the Due (see sim::costs). Buses and pins are connected to the simulated devices of sim::world.
+namespace hwlib {
+
+uint_fast64_t now_ticks();
+uint_fast64_t ticks_per_us();
+uint_fast64_t now_us();
+void wait_ns(int_fast32_t ns);
+void wait_us(int_fast32_t us);
+void wait_ms(int_fast32_t ms);
+
+class pin_out {
+public:
+    virtual void write(bool value) = 0;
+    virtual void flush(){}
+};
+
+class pin_in {
+public:
+    virtual bool read() = 0;
+    virtual void refresh(){}
+};
+
+class pin_oc {
+public:
+    virtual void write(bool value) = 0;
+    virtual bool read() = 0;
+    virtual void flush(){}
+    virtual void refresh(){}
+};
+
+class ostream {
+private:
+    bool hexadecimal = false;
+    void number(unsigned long long value, bool negative);
+public:
+    virtual ~ostream(){}
+    virtual void putc(char c) = 0;
+    virtual void flush(){}
+
+    void base(bool hex){ hexadecimal = hex; }
+
+    ostream & operator<<(char c){ putc(c); return *this; }
+    ostream & operator<<(const char * text){ while(*text){ putc(*text++); } return *this; }
+    ostream & operator<<(bool value){ return *this << (value ? "1" : "0"); }
+    ostream & operator<<(unsigned char value){ number(value, false); return *this; }
+    ostream & operator<<(int value){ number(value < 0 ? -(long long)value : value, value < 0); return *this; }
+    ostream & operator<<(unsigned int value){ number(value, false); return *this; }
+    ostream & operator<<(long value){ number(value < 0 ? -(long long)value : value, value < 0); return *this; }
+    ostream & operator<<(unsigned long value){ number(value, false); return *this; }
+    ostream & operator<<(long long value){ number(value < 0 ? -value : value, value < 0); return *this; }
+    ostream & operator<<(unsigned long long value){ number(value, false); return *this; }
+    ostream & operator<<(ostream & (*manipulator)(ostream &)){ return manipulator(*this); }
+};
+
+ostream & hex(ostream & out);
+ostream & dec(ostream & out);
+ostream & endl(ostream & out);
+ostream & flush(ostream & out);
+
+/// @brief The serial port of the Due, every character takes the time of 115200 baud.
+class uart_ostream : public ostream {
+public:
+    void putc(char c) override;
+};
+extern uart_ostream cout;
+
+class spi_bus;
+
+class spi_transaction {
+private:
+    spi_bus & bus;
+    pin_out & select;
+public:
+    spi_transaction(spi_bus & bus, pin_out & select):
+        bus( bus ),
+        select( select )
+        {}
+
+    void write_and_read(size_t n, const uint8_t data_out[], uint8_t data_in[]);
+};
+
+class spi_bus {
+public:
+    virtual ~spi_bus(){}
+    spi_transaction transaction(pin_out & select){ return spi_transaction(*this, select); }
+
+    /// @brief One transaction, data_out or data_in can be nullptr.
+    virtual void write_and_read(pin_out & select, size_t n, const uint8_t data_out[], uint8_t data_in[]) = 0;
+};
+
+/// @brief The bit banged bus of the station, connected to the device on the select pin.
+class spi_bus_bit_banged_sclk_mosi_miso : public spi_bus {
+public:
+    spi_bus_bit_banged_sclk_mosi_miso(pin_out & sclk, pin_out & mosi, pin_in & miso);
+    void write_and_read(pin_out & select, size_t n, const uint8_t data_out[], uint8_t data_in[]) override;
+};
+
+class i2c_bus;
+
+class i2c_write_transaction {
+private:
+    i2c_bus & bus;
+    uint_fast8_t address;
+    std::vector< uint8_t > sent;
+public:
+    i2c_write_transaction(i2c_bus & bus, uint_fast8_t address);
+    ~i2c_write_transaction();
+    void write(uint8_t byte);
+    void write(const uint8_t data[], size_t n);
+};
+
+class i2c_read_transaction {
+private:
+    i2c_bus & bus;
+    uint_fast8_t address;
+    std::vector< uint8_t > received;
+public:
+    i2c_read_transaction(i2c_bus & bus, uint_fast8_t address);
+    ~i2c_read_transaction();
+    void read(uint8_t & byte);
+    void read(uint8_t data[], size_t n);
+    uint8_t read_byte();
+};
+
+class i2c_bus {
+public:
+    virtual ~i2c_bus(){}
+    i2c_write_transaction write(uint_fast8_t address){ return i2c_write_transaction(*this, address); }
+    i2c_read_transaction read(uint_fast8_t address){ return i2c_read_transaction(*this, address); }
+};
+
+/// @brief The bit banged bus of the station, connected to the devices by their address.
+class i2c_bus_bit_banged_scl_sda : public i2c_bus {
+public:
+    i2c_bus_bit_banged_scl_sda(pin_oc & scl, pin_oc & sda);
+};
+
+namespace target {
+
+enum class pins { d0, d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11, d12, d13, d22, d24, d26, d28, d30, d31, d32, d33,
+                  d34, d35, d36, d37, d38, d39, d40, scl, sda, a0, amount };
+
+class pin_out : public hwlib::pin_out {
+public:
+    const pins number;
+    pin_out(pins number);
+    void write(bool value) override;
+};
+
+class pin_in : public hwlib::pin_in {
+public:
+    const pins number;
+    pin_in(pins number);
+    bool read() override;
+};
+
+class pin_oc : public hwlib::pin_oc {
+public:
+    const pins number;
+    pin_oc(pins number);
+    void write(bool value) override;
+    bool read() override;
+};
+
+}   //namespace target
+}   //namespace hwlib
+
+#ifdef __SAM3X8E__
+/// The registers of the SAM3X timer that dueTickCounter uses, TC0 channel 2 counts the SQW/OUT of the simulated DS1307.
+struct Pmc { uint32_t PMC_PCER0; };
+struct Pio { uint32_t PIO_PDR, PIO_ABSR, PIO_PUER; };
+struct TcChannel { uint32_t TC_CMR, TC_CCR, TC_CV; };
+struct Tc { uint32_t TC_BMR; TcChannel TC_CHANNEL[3]; };
+extern Pmc * const PMC;
+extern Pio * const PIOA;
+extern Tc * const TC0;
+#define ID_TC2                  29
+#define PIO_PA7                 (1u << 7)
+#define TC_BMR_TC2XC2S_Msk      (3u << 4)
+#define TC_BMR_TC2XC2S_TCLK2    (0u << 4)
+#define TC_CMR_TCCLKS_XC2       7u
+#define TC_CCR_CLKEN            1u
+#define TC_CCR_SWTRG            4u
+#endif
+
+#endif //SIM_HWLIB_HPP
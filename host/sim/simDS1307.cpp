@@ -0,0 +1,100 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "simDS1307.hpp"
+#include "DS1307.hpp"
+
+namespace sim {
+
+static uint8_t bcd(uint8_t value){
+    return uint8_t((value / 10) << 4 | (value % 10));
+}
+
+static uint8_t decimal(uint8_t value){
+    return uint8_t((value >> 4) * 10 + (value & 0x0F));
+}
+
+rtc::rtc(world & due, uint32_t start):
+    due( due ),
+    baseSeconds( start )
+{
+    due.connect(0x68, *this);
+    due.onAdvance([this](uint64_t now){ tick(now); });
+    latch(0);
+}
+
+void rtc::latch(uint64_t now){
+    uint8_t data[7];
+    DS1307::datum_van_tijdstip(seconds(now), data);
+    registers[0] = bcd(data[6]);
+    registers[1] = bcd(data[5]);
+    registers[2] = bcd(data[4]);    //24 hour format
+    registers[3] = data[0];
+    registers[4] = bcd(data[1]);
+    registers[5] = bcd(data[2]);
+    registers[6] = bcd(data[3]);
+}
+
+void rtc::tick(uint64_t now){
+    if(squareWave() != counting){   //the counter keeps its value while there are no edges
+        counting = squareWave();
+        if(counting){
+            counterOffset = counterFrozen - uint32_t(edges(now));
+        }else{
+            counterFrozen = uint32_t(edges(now)) + counterOffset;
+        }
+    }
+#ifdef __SAM3X8E__
+    TC0->TC_CHANNEL[2].TC_CV = counting ? uint32_t(edges(now)) + counterOffset : counterFrozen;
+#endif
+}
+
+void rtc::begin(bool reading){
+    addressed = !reading;
+    if(reading){
+        latch(due.now());
+    }
+}
+
+void rtc::write(uint8_t byte){
+    if(addressed){      //the first byte is the register pointer
+        pointer = byte & 0x3F;
+        addressed = false;
+        return;
+    }
+    registers[pointer] = byte;
+    timeWritten |= pointer < 7;
+    if(pointer == 0x07){    //the square wave starts or stops right away, not at the next tick
+        tick(due.now());
+    }
+    pointer = (pointer + 1) & 0x3F;
+}
+
+uint8_t rtc::read(){
+    uint8_t byte = registers[pointer];
+    pointer = (pointer + 1) & 0x3F;
+    return byte;
+}
+
+void rtc::stop(){
+    if(!timeWritten){
+        return;
+    }
+    timeWritten = false;
+    uint8_t data[7];
+    data[0] = registers[3];
+    data[1] = decimal(registers[4]);
+    data[2] = decimal(registers[5]);
+    data[3] = decimal(registers[6]);
+    data[4] = decimal(registers[2] & 0x3F);
+    data[5] = decimal(registers[1]);
+    data[6] = decimal(registers[0] & 0x7F);
+    baseSeconds = DS1307::tijdstip_van_datum(data);
+    uint32_t counter = counting ? uint32_t(edges(due.now())) + counterOffset : counterFrozen;
+    phase = due.now();  //the divider chain restarts when the seconds are written
+    counterOffset = counter;
+}
+
+}   //namespace sim
@@ -0,0 +1,53 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIMDS1307_HPP
+#define SIMDS1307_HPP
+
+#include "simWorld.hpp"
+
+/// @file
+
+namespace sim {
+
+/// @brief
+/// The DS1307 on the I2C bus
+/// @detail
+/// The time registers follow the virtual time, with the date format of DS1307::tijdstip_van_datum.
+/// The time is latched at the start of a read like on the chip. Writing a time register restarts the second at that moment.
+/// With the square wave on at 32.768 kHz, TC0 channel 2 counts its edges in phase with the seconds.
+class rtc : public i2cDevice {
+private:
+    world & due;
+    uint8_t registers[64] = {};
+    uint8_t pointer = 0;
+    bool addressed = false;
+    bool timeWritten = false;
+    uint32_t baseSeconds;
+    uint64_t phase = 0;
+    uint32_t counterOffset = 0;
+    uint32_t counterFrozen = 0;
+    bool counting = false;
+
+    uint64_t edges(uint64_t now) const { return (now - phase) * 32768 / 1000000000ull; }
+    bool squareWave() const { return (registers[0x07] & 0x13) == 0x13; }
+    void latch(uint64_t now);
+    void tick(uint64_t now);
+public:
+    /// @brief Connect the DS1307 to the bus at 0x68, running from a time in seconds since 1/1/1952.
+    rtc(world & due, uint32_t start);
+
+    /// @brief Seconds since 1/1/1952 at a moment.
+    uint32_t seconds(uint64_t now) const { return baseSeconds + uint32_t((now - phase) / 1000000000ull); }
+
+    void begin(bool reading) override;
+    void write(uint8_t byte) override;
+    uint8_t read() override;
+    void stop() override;
+};
+
+}   //namespace sim
+
+#endif //SIMDS1307_HPP
@@ -0,0 +1,195 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "hwlib.hpp"
+#include "simWorld.hpp"
+#include <vector>
+
+using sim::world;
+using sim::costs;
+
+namespace hwlib {
+
+uint_fast64_t now_ticks(){
+    world::current().advance(costs::nowUs);
+    world::current().checkEnd();
+    return world::current().now() / 1000;
+}
+
+uint_fast64_t ticks_per_us(){
+    return 1;
+}
+
+uint_fast64_t now_us(){
+    return now_ticks();
+}
+
+void wait_ns(int_fast32_t ns){
+    world::current().advance(ns > 0 ? ns : 0);
+    world::current().checkEnd();
+}
+
+void wait_us(int_fast32_t us){
+    wait_ns(us * 1000);
+}
+
+void wait_ms(int_fast32_t ms){
+    world::current().advance(ms > 0 ? uint64_t(ms) * 1000000 : 0);
+    world::current().checkEnd();
+}
+
+void ostream::number(unsigned long long value, bool negative){
+    char digits[24];
+    int n = 0;
+    unsigned base = hexadecimal ? 16 : 10;
+    do {
+        digits[n++] = "0123456789ABCDEF"[value % base];
+        value /= base;
+    } while(value != 0);
+    if(negative){
+        putc('-');
+    }
+    while(n > 0){
+        putc(digits[--n]);
+    }
+}
+
+ostream & hex(ostream & out){ out.base(true); return out; }
+ostream & dec(ostream & out){ out.base(false); return out; }
+ostream & endl(ostream & out){ out.putc('\n'); out.flush(); return out; }
+ostream & flush(ostream & out){ out.flush(); return out; }
+
+void uart_ostream::putc(char c){
+    world::current().advance(costs::uartChar);
+    world::current().serialPut(c);
+}
+
+uart_ostream cout;
+
+void spi_transaction::write_and_read(size_t n, const uint8_t data_out[], uint8_t data_in[]){
+    bus.write_and_read(select, n, data_out, data_in);
+}
+
+spi_bus_bit_banged_sclk_mosi_miso::spi_bus_bit_banged_sclk_mosi_miso(pin_out &, pin_out &, pin_in &){}
+
+void spi_bus_bit_banged_sclk_mosi_miso::write_and_read(pin_out & select, size_t n, const uint8_t data_out[], uint8_t data_in[]){
+    world & due = world::current();
+    due.advance(n * costs::spiByte);
+    std::vector< uint8_t > out(n, 0x00);
+    std::vector< uint8_t > in(n, 0xFF);     //nothing connected reads as all ones
+    if(data_out != nullptr){
+        out.assign(data_out, data_out + n);
+    }
+    auto pin = dynamic_cast< target::pin_out * >(&select);
+    if(pin != nullptr && due.spiAt(pin->number) != nullptr){
+        due.spiAt(pin->number)->transfer(n, out.data(), in.data());
+    }
+    if(data_in != nullptr){
+        for(size_t i = 0; i < n; i++){
+            data_in[i] = in[i];
+        }
+    }
+    if(n > 0){  //register framing of spiSetup: the first byte is the address, bit 7 set for a read
+        uint8_t reg = (out[0] >> 1) & 0x3F;
+        if(out[0] & 0x80){
+            due.busTransaction(sim::busObserver::spiRead, reg, in.data() + 1, n - 1);
+        }else{
+            due.busTransaction(sim::busObserver::spiWrite, reg, out.data() + 1, n - 1);
+        }
+    }
+}
+
+i2c_write_transaction::i2c_write_transaction(i2c_bus & bus, uint_fast8_t address):
+    bus( bus ),
+    address( address )
+{
+    world::current().advance(costs::i2cByte);
+    if(auto device = world::current().i2cAt(address)){
+        device->begin(false);
+    }
+}
+
+i2c_write_transaction::~i2c_write_transaction(){
+    world::current().busTransaction(sim::busObserver::i2cWrite, address, sent.data(), sent.size());
+    if(auto device = world::current().i2cAt(address)){
+        device->stop();
+    }
+}
+
+void i2c_write_transaction::write(uint8_t byte){
+    world::current().advance(costs::i2cByte);
+    sent.push_back(byte);
+    if(auto device = world::current().i2cAt(address)){
+        device->write(byte);
+    }
+}
+
+void i2c_write_transaction::write(const uint8_t data[], size_t n){
+    for(size_t i = 0; i < n; i++){
+        write(data[i]);
+    }
+}
+
+i2c_read_transaction::i2c_read_transaction(i2c_bus & bus, uint_fast8_t address):
+    bus( bus ),
+    address( address )
+{
+    world::current().advance(costs::i2cByte);
+    if(auto device = world::current().i2cAt(address)){
+        device->begin(true);
+    }
+}
+
+i2c_read_transaction::~i2c_read_transaction(){
+    world::current().busTransaction(sim::busObserver::i2cRead, address, received.data(), received.size());
+    if(auto device = world::current().i2cAt(address)){
+        device->stop();
+    }
+}
+
+void i2c_read_transaction::read(uint8_t & byte){
+    world::current().advance(costs::i2cByte);
+    auto device = world::current().i2cAt(address);
+    byte = device != nullptr ? device->read() : 0xFF;
+    received.push_back(byte);
+}
+
+void i2c_read_transaction::read(uint8_t data[], size_t n){
+    for(size_t i = 0; i < n; i++){
+        read(data[i]);
+    }
+}
+
+uint8_t i2c_read_transaction::read_byte(){
+    uint8_t byte;
+    read(byte);
+    return byte;
+}
+
+i2c_bus_bit_banged_scl_sda::i2c_bus_bit_banged_scl_sda(pin_oc &, pin_oc &){}
+
+namespace target {
+
+pin_out::pin_out(pins number): number( number ){}
+void pin_out::write(bool value){ world::current().pinWrite(number, value); }
+
+pin_in::pin_in(pins number): number( number ){}
+bool pin_in::read(){ return world::current().pinRead(number); }
+
+pin_oc::pin_oc(pins number): number( number ){}
+void pin_oc::write(bool value){ world::current().pinWrite(number, value); }
+bool pin_oc::read(){ return world::current().pinRead(number); }
+
+}   //namespace target
+}   //namespace hwlib
+
+#ifdef __SAM3X8E__
+static Pmc simPmc;
+static Pio simPioa;
+static Tc simTc0;
+Pmc * const PMC = &simPmc;
+Pio * const PIOA = &simPioa;
+Tc * const TC0 = &simTc0;
+#endif
@@ -0,0 +1,451 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "simMFRC522.hpp"
+#include "cardStorage.hpp"
+#include <algorithm>
+
+namespace sim {
+
+uint16_t crcA(const uint8_t data[], size_t n){
+    uint16_t crc = 0x6363;
+    for(size_t i = 0; i < n; i++){
+        uint8_t byte = data[i] ^ uint8_t(crc);
+        byte ^= byte << 4;
+        crc = (crc >> 8) ^ (uint16_t(byte) << 8) ^ (uint16_t(byte) << 3) ^ (byte >> 4);
+    }
+    return crc;
+}
+
+static bool crcOk(const std::vector< uint8_t > & frame){
+    size_t n = frame.size();
+    return n >= 3 && crcA(frame.data(), n - 2) == (frame[n - 2] | (frame[n - 1] << 8));
+}
+
+static void addCrc(std::vector< uint8_t > & frame){
+    uint16_t crc = crcA(frame.data(), frame.size());
+    frame.push_back(uint8_t(crc));
+    frame.push_back(uint8_t(crc >> 8));
+}
+
+//################################################################################################################
+
+card::card(const cardUID & uid):
+    uid( uid )
+{
+    for(auto & block : blocks){
+        for(auto & byte : block){
+            byte = 0x00;
+        }
+    }
+    for(uint8_t i = 0; i < 4; i++){
+        blocks[0][i] = uid[i];
+    }
+    blocks[0][4] = uid.bcc();
+    blocks[0][5] = 0x08;    //SAK
+    blocks[0][6] = 0x04;    //ATQA
+    for(uint8_t sector = 0; sector < 16; sector++){
+        static const uint8_t trailer[16] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x80, 0x69,
+                                            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        for(uint8_t i = 0; i < 16; i++){
+            blocks[sector * 4 + 3][i] = trailer[i];
+        }
+    }
+}
+
+void card::reset(){
+    current = wasHalted ? state::halt : state::idle;
+    authenticatedSector = 0xFF;
+    pendingWrite = -1;
+}
+
+void card::powerOn(uint64_t now){
+    if(current == state::off){
+        current = state::idle;
+        wasHalted = false;
+        authenticatedSector = 0xFF;
+        pendingWrite = -1;
+        poweredSince = now;
+    }
+}
+
+void card::powerOff(){
+    current = state::off;
+}
+
+bool card::authenticate(uint8_t keyType, uint8_t block, const uint8_t key[6], const uint8_t checkUID[4]){
+    if(current != state::active || block >= 64 || cardUID(checkUID) != uid){
+        reset();
+        return false;
+    }
+    const uint8_t * trailer = blocks[(block / 4) * 4 + 3];
+    const uint8_t * expected = keyType == 0x61 ? &trailer[10] : &trailer[0];
+    for(uint8_t i = 0; i < 6; i++){
+        if(key[i] != expected[i]){
+            reset();
+            return false;
+        }
+    }
+    authenticatedSector = block / 4;
+    return true;
+}
+
+bool card::answer(const std::vector< uint8_t > & frame, uint8_t lastBits, uint64_t now, std::vector< uint8_t > & response, uint64_t & extra){
+    if(!respond(frame, lastBits, now, response, extra)){
+        return false;
+    }
+    noise = noise * 1103515245u + 12345u;
+    if(lossPercent > 0 && (noise >> 16) % 100 < lossPercent){
+        response.clear();
+        lost++;
+        return false;
+    }
+    return true;
+}
+
+bool card::respond(const std::vector< uint8_t > & frame, uint8_t lastBits, uint64_t now, std::vector< uint8_t > & response, uint64_t & extra){
+    response.clear();
+    extra = 0;
+    if(!ready(now) || frame.empty()){
+        return false;
+    }
+    const size_t n = frame.size();
+    if(lastBits == 7 && n == 1 && (frame[0] == 0x26 || frame[0] == 0x52)){     //REQA and WUPA
+        if(current == state::idle || (current == state::halt && frame[0] == 0x52)){
+            wasHalted = current == state::halt;
+            current = state::ready;
+            response = {0x04, 0x00};
+            return true;
+        }
+        if(current != state::halt){
+            reset();
+        }
+        return false;
+    }
+    if(current == state::ready){
+        if(n == 2 && frame[0] == 0x93 && frame[1] == 0x20){     //anticollision
+            response = {uid[0], uid[1], uid[2], uid[3], uid.bcc()};
+            return true;
+        }
+        if(n == 9 && frame[0] == 0x93 && frame[1] == 0x70 && crcOk(frame) && cardUID(&frame[2]) == uid && frame[6] == uid.bcc()){
+            current = state::active;
+            response = {0x08};
+            addCrc(response);
+            return true;
+        }
+        reset();
+        return false;
+    }
+    if(current != state::active){
+        return false;
+    }
+    if(pendingWrite >= 0){      //second part of WRITE, the data
+        int block = pendingWrite;
+        pendingWrite = -1;
+        if(n != 18 || !crcOk(frame)){
+            reset();
+            return false;
+        }
+        for(uint8_t i = 0; i < 16; i++){
+            blocks[block][i] = frame[i];
+        }
+        extra = rf::eeprom;
+        writes.push_back(now + rf::frameDelay + extra);
+        response = {0x0A};
+        return true;
+    }
+    if(!crcOk(frame)){
+        return false;
+    }
+    if(n == 4 && frame[0] == 0x30 && frame[1] < 64){    //READ
+        if(frame[1] / 4 != authenticatedSector){
+            response = {0x04};
+            reset();
+            return true;
+        }
+        response.assign(blocks[frame[1]], blocks[frame[1]] + 16);
+        addCrc(response);
+        return true;
+    }
+    if(n == 4 && frame[0] == 0xA0 && frame[1] < 64){    //WRITE, first part
+        if(frame[1] / 4 != authenticatedSector || frame[1] == 0){
+            response = {0x04};
+            reset();
+            return true;
+        }
+        pendingWrite = frame[1];
+        response = {0x0A};
+        return true;
+    }
+    if(n == 4 && frame[0] == 0x50 && frame[1] == 0x00){    //HLTA
+        wasHalted = true;
+        reset();
+        return false;
+    }
+    reset();
+    return false;
+}
+
+bool card::readBlock(uint8_t block, uint8_t data[16]){
+    uint8_t physical = cardStorage::physicalBlock(block);
+    for(uint8_t i = 0; i < 16; i++){
+        data[i] = blocks[physical][i];
+    }
+    return true;
+}
+
+bool card::writeBlock(uint8_t block, const uint8_t data[16]){
+    uint8_t physical = cardStorage::physicalBlock(block);
+    for(uint8_t i = 0; i < 16; i++){
+        blocks[physical][i] = data[i];
+    }
+    return true;
+}
+
+uint8_t card::blockCount() const {
+    return cardStorage::dataBlocks;
+}
+
+//################################################################################################################
+
+chip::chip(world & due, hwlib::target::pins select, hwlib::target::pins reset):
+    due( due )
+{
+    due.connect(select, *this);
+    due.observe(reset, [this](bool high){
+        if(high){   //out of the hard power down
+            powerUp(this->due.now(), rf::boot);
+        }
+    });
+    powerUp(0, rf::boot);
+}
+
+void chip::antennaChanged(bool was, uint64_t now){
+    if(was == antenna()){
+        return;
+    }
+    if(antenna()){
+        fieldSince = std::max(now, bootUntil);     //after a soft power-down the field comes back with the oscillator
+        if(field != nullptr){
+            field->powerOn(fieldSince);
+        }
+    }else{
+        fieldOn += now > fieldSince ? now - fieldSince : 0;
+        if(field != nullptr){
+            field->powerOff();
+        }
+    }
+}
+
+void chip::powerUp(uint64_t now, uint64_t boot){
+    bool was = antenna();
+    for(auto & reg : registers){
+        reg = 0x00;
+    }
+    registers[0x01] = 0x20;     //CommandReg, RcvOff
+    registers[0x0B] = 0x08;     //WaterLevelReg
+    registers[0x0E] = 0x80;     //CollReg
+    registers[0x11] = 0x3F;     //ModeReg
+    registers[0x14] = 0x80;     //TxControlReg, antennas off
+    registers[0x26] = 0x48;     //RFCfgReg
+    registers[0x37] = 0x92;     //VersionReg, version 2.0
+    fifo.clear();
+    irq = 0x14;
+    error = 0;
+    op = operation();
+    bootUntil = now + boot;
+    sleeping = false;
+    antennaChanged(was, now);
+}
+
+uint64_t chip::timerPeriod() const {
+    uint64_t prescaler = (uint64_t(registers[0x2A] & 0x0F) << 8) | registers[0x2B];
+    uint64_t reload = (uint64_t(registers[0x2C]) << 8) | registers[0x2D];
+    return (reload + 1) * (2 * prescaler + 1) * 1000000000ull / 13560000ull;
+}
+
+void chip::update(uint64_t now){
+    if(!op.active){
+        return;
+    }
+    if(!op.processed && now >= op.txEnd){
+        op.processed = true;
+        uint64_t extra = 0;
+        if(op.command == 0x04){     //Transmit is done as soon as the frame is out
+            irq |= 0x40 | 0x10;
+            if(field != nullptr){
+                field->answer(op.frame, op.lastBits, op.txEnd, op.response, extra);
+            }
+            registers[0x01] &= 0xF0;
+            op.active = false;
+            return;
+        }
+        if(op.command == 0x0C){
+            irq |= 0x40;
+            op.answered = field != nullptr && field->answer(op.frame, op.lastBits, op.txEnd, op.response, extra);
+            if(op.answered){
+                bool ack = op.response.size() == 1;     //ACK and NAK are 4 bits
+                op.done = op.txEnd + rf::frameDelay + extra + rf::airTime(op.response.size(), ack ? 4 : 0);
+            }else{
+                op.done = op.txEnd + timerPeriod();
+            }
+        }else{  //MFAuthent
+            op.answered = field != nullptr && op.frame.size() == 12 && field->ready(op.txEnd) &&
+                          field->authenticate(op.frame[0], op.frame[1], &op.frame[2], &op.frame[8]);
+            op.done = op.start + (op.answered ? rf::authent : timerPeriod());
+        }
+    }
+    if(op.processed && now >= op.done){
+        op.active = false;
+        if(!op.answered){
+            irq |= 0x01;    //TimerIRq
+        }else if(op.command == 0x0C){
+            fifo.assign(op.response.begin(), op.response.end());
+            irq |= 0x20;    //RxIRq
+        }else{
+            registers[0x08] |= 0x08;    //MFCrypto1On
+            irq |= 0x10;    //IdleIRq
+            registers[0x01] &= 0xF0;
+        }
+    }
+}
+
+void chip::transmit(uint8_t command, uint64_t now){
+    op = operation();
+    op.active = true;
+    op.command = command;
+    op.frame.assign(fifo.begin(), fifo.end());
+    fifo.clear();
+    op.lastBits = registers[0x0D] & 0x07;
+    op.start = now;
+    op.txEnd = now + rf::airTime(op.frame.size(), op.lastBits);
+}
+
+void chip::startCommand(uint8_t command, uint64_t now){
+    op.active = false;  //a new command stops the running one
+    switch(command){
+        case 0x03: {    //CalcCRC
+            std::vector< uint8_t > data(fifo.begin(), fifo.end());
+            fifo.clear();
+            uint16_t crc = crcA(data.data(), data.size());
+            registers[0x21] = uint8_t(crc >> 8);
+            registers[0x22] = uint8_t(crc);
+            registers[0x05] |= 0x04;    //CRCIRq
+            break;
+        }
+        case 0x04:      //Transmit
+            transmit(command, now);
+            break;
+        case 0x0E:      //MFAuthent
+            transmit(command, now);
+            op.txEnd = now;
+            break;
+        case 0x0F:      //SoftReset
+            powerUp(now, rf::boot);
+            break;
+        default:        //Idle, and Transceive waits for StartSend
+            break;
+    }
+}
+
+uint8_t chip::readRegister(uint8_t address, uint64_t now){
+    update(now);
+    switch(address){
+        case 0x01: return registers[0x01] | (now < bootUntil ? 0x10 : 0x00);
+        case 0x04: return irq;
+        case 0x06: return error;
+        case 0x09: {
+            if(fifo.empty()){
+                return 0x00;
+            }
+            uint8_t byte = fifo.front();
+            fifo.pop_front();
+            return byte;
+        }
+        case 0x0A: return uint8_t(fifo.size());
+        default: return registers[address];
+    }
+}
+
+void chip::writeRegister(uint8_t address, uint8_t value, uint64_t now){
+    update(now);
+    switch(address){
+        case 0x01: {
+            bool was = antenna();
+            if(sleeping && !(value & 0x10)){    //out of the soft power-down, the oscillator starts again
+                bootUntil = now + rf::boot;
+            }
+            sleeping = (value & 0x10) != 0;
+            registers[0x01] = value & 0x3F;
+            startCommand(value & 0x0F, now);
+            antennaChanged(was, now);
+            break;
+        }
+        case 0x04:
+            irq = (value & 0x80) ? (irq | (value & 0x7F)) : (irq & ~value);
+            break;
+        case 0x05:
+            registers[0x05] = (value & 0x80) ? (registers[0x05] | (value & 0x7F)) : (registers[0x05] & ~value);
+            break;
+        case 0x09:
+            if(fifo.size() < 64){
+                fifo.push_back(value);
+            }else{
+                error |= 0x10;  //BufferOvfl
+            }
+            break;
+        case 0x0A:
+            if(value & 0x80){
+                fifo.clear();
+                error &= ~0x10;
+            }
+            break;
+        case 0x0D:
+            registers[0x0D] = value & 0x7F;
+            if((value & 0x80) && (registers[0x01] & 0x0F) == 0x0C && !op.active){   //StartSend
+                transmit(0x0C, now);
+            }
+            break;
+        case 0x14: {
+            bool was = antenna();
+            registers[0x14] = value;
+            antennaChanged(was, now);
+            break;
+        }
+        default:
+            registers[address] = value;
+            break;
+    }
+}
+
+void chip::transfer(size_t n, const uint8_t out[], uint8_t in[]){
+    const uint64_t now = due.now();
+    if(n == 0){
+        return;
+    }
+    in[0] = 0x00;
+    if(out[0] & 0x80){      //every byte answers the address that was sent before it
+        for(size_t i = 0; i + 1 < n; i++){
+            in[i + 1] = readRegister((out[i] >> 1) & 0x3F, now);
+        }
+    }else{
+        for(size_t i = 1; i < n; i++){
+            writeRegister((out[0] >> 1) & 0x3F, out[i], now);
+        }
+    }
+}
+
+void chip::place(card * newCard){
+    update(due.now());
+    if(field != nullptr){
+        field->powerOff();
+    }
+    field = newCard;
+    if(field != nullptr && antenna()){
+        field->powerOn(due.now());
+    }
+}
+
+}   //namespace sim
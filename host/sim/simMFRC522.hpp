@@ -0,0 +1,145 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIMMFRC522_HPP
+#define SIMMFRC522_HPP
+
+#include "simWorld.hpp"
+#include "punchLog.hpp"
+#include "cardUID.hpp"
+#include <deque>
+#include <vector>
+
+/// @file
+
+namespace sim {
+
+/// @brief Timing of the RF side at 106 kbit/s, in ns.
+struct rf {
+    static constexpr uint64_t bit       = 9440;     ///< One bit on the air.
+    static constexpr uint64_t frameDelay = 86000;   ///< Frame delay time, from the end of the command to the answer.
+    static constexpr uint64_t powerUp   = 2000000;  ///< A card in the field answers after it has power for this long.
+    static constexpr uint64_t eeprom    = 4000000;  ///< Programming a block before the card sends the ACK.
+    static constexpr uint64_t authent   = 1200000;  ///< The three pass authentication.
+    static constexpr uint64_t boot      = 1000000;  ///< Oscillator start up after a reset or a soft power-down.
+
+    /// @brief Air time of a frame, with a parity bit for every byte and start and end of frame.
+    static uint64_t airTime(size_t bytes, uint8_t lastBits = 0){
+        return (lastBits ? (bytes - 1) * 9 + lastBits + 1 : bytes * 9) * bit + 2 * bit;
+    }
+};
+
+/// @brief CRC_A of ISO 14443-3, the CRC of the MFRC522 with preset 0x6363.
+uint16_t crcA(const uint8_t data[], size_t n);
+
+/// @brief
+/// A MIFARE Classic 1K card
+/// @detail
+/// Answers REQA, anticollision, SELECT, READ, WRITE and HLTA like a real card and keeps its 64 blocks.
+/// Every sector has key A and key B FFFFFFFFFFFF. The data is not encrypted, the card only checks that the sector is authenticated.
+class card : public blockStorage {
+private:
+    enum class state { off, idle, ready, active, halt };
+    state current = state::off;
+    bool wasHalted = false;
+    uint64_t poweredSince = 0;
+    uint8_t authenticatedSector = 0xFF;
+    int pendingWrite = -1;
+
+    void reset();
+
+    bool respond(const std::vector< uint8_t > & frame, uint8_t lastBits, uint64_t now, std::vector< uint8_t > & response, uint64_t & extra);
+public:
+    const cardUID uid;
+    uint8_t blocks[64][16];
+
+    /// @brief Moments a block was written, the last write of a punch is when the card has it.
+    std::vector< uint64_t > writes;
+
+    /// @brief Share of the answers that get lost, for a card in a marginal position. The card did handle the frame.
+    uint8_t lossPercent = 0;
+    /// @brief State of the generator that picks the lost answers.
+    uint32_t noise = 1;
+    /// @brief Answers lost.
+    uint32_t lost = 0;
+
+    card(const cardUID & uid);
+
+    void powerOn(uint64_t now);
+    void powerOff();
+    bool ready(uint64_t now) const { return current != state::off && now >= poweredSince + rf::powerUp; }
+
+    /// @brief The MFAuthent of the reader, returns false when the card doesn't go along.
+    bool authenticate(uint8_t keyType, uint8_t block, const uint8_t key[6], const uint8_t uid[4]);
+
+    /// @brief Handle a frame, returns false when the card keeps quiet.
+    /// @param extra Time the card needs before it answers, after the frame delay.
+    bool answer(const std::vector< uint8_t > & frame, uint8_t lastBits, uint64_t now, std::vector< uint8_t > & response, uint64_t & extra);
+
+    //blockStorage with the data blocks of cardStorage, to prepare the card and check it afterwards
+    bool readBlock(uint8_t block, uint8_t data[16]) override;
+    bool writeBlock(uint8_t block, const uint8_t data[16]) override;
+    uint8_t blockCount() const override;
+};
+
+/// @brief
+/// The MFRC522 on the SPI bus
+/// @detail
+/// Registers, FIFO, CRC coprocessor, timer and the commands the driver uses: Idle, CalcCRC, Transmit, Transceive, MFAuthent and SoftReset.
+/// Commands finish at the moment they would on the chip, the registers are brought up to date on every access.
+/// The PowerDown bit of CommandReg switches the field off, the chip keeps its registers and wakes up like after a reset.
+class chip : public spiDevice {
+private:
+    world & due;
+    uint8_t registers[64] = {};
+    std::deque< uint8_t > fifo;
+    uint8_t irq = 0x14;
+    uint8_t error = 0;
+    uint64_t bootUntil = 0;
+    bool sleeping = false;
+    card * field = nullptr;
+    uint64_t fieldOn = 0;
+    uint64_t fieldSince = 0;
+
+    struct operation {
+        bool active = false;
+        bool processed = false;
+        bool answered = false;
+        uint8_t command = 0;
+        std::vector< uint8_t > frame;
+        uint8_t lastBits = 0;
+        uint64_t start = 0;
+        uint64_t txEnd = 0;
+        uint64_t done = 0;
+        std::vector< uint8_t > response;
+    };
+    operation op;
+
+    void powerUp(uint64_t now, uint64_t boot);
+    bool antenna() const { return !sleeping && (registers[0x14] & 0x03) != 0; }
+    void antennaChanged(bool was, uint64_t now);
+    uint64_t timerPeriod() const;
+    void update(uint64_t now);
+    void startCommand(uint8_t command, uint64_t now);
+    void transmit(uint8_t command, uint64_t now);
+    uint8_t readRegister(uint8_t address, uint64_t now);
+    void writeRegister(uint8_t address, uint8_t value, uint64_t now);
+public:
+    /// @brief Connect the chip to the select and reset pins.
+    chip(world & due, hwlib::target::pins select, hwlib::target::pins reset);
+
+    void transfer(size_t n, const uint8_t out[], uint8_t in[]) override;
+
+    /// @brief Put a card on the reader, nullptr takes it away.
+    void place(card * newCard);
+    card * inField() const { return field; }
+
+    /// @brief Time the field was on since power on, in ns. What the antennas draw is most of the current of the reader.
+    uint64_t fieldTime(uint64_t now) const { return fieldOn + (antenna() && now > fieldSince ? now - fieldSince : 0); }
+};
+
+}   //namespace sim
+
+#endif //SIMMFRC522_HPP
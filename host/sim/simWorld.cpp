@@ -0,0 +1,56 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "simWorld.hpp"
+#include <cstdio>
+
+namespace sim {
+
+world & world::current(){
+    static world due;
+    return due;
+}
+
+void world::advance(uint64_t ns){
+    time += ns;
+    while(!queue.empty() && queue.top().time <= time){
+        auto action = queue.top().action;   //the action can add events, so it is taken off first
+        queue.pop();
+        action();
+    }
+    for(auto & ticker : tickers){
+        ticker(time);
+    }
+}
+
+void world::checkEnd() const {
+    if(time >= endTime){
+        throw finished();
+    }
+}
+
+void world::at(uint64_t moment, std::function< void() > action){
+    queue.push({moment, events++, action});
+}
+
+void world::pinWrite(hwlib::target::pins pin, bool value){
+    size_t index = size_t(pin);
+    if(outputs[index] == value){
+        return;
+    }
+    outputs[index] = value;
+    for(auto & observer : observers[index]){
+        observer(value);
+    }
+}
+
+void world::serialPut(char c){
+    serial.push_back(c);
+    if(echo){
+        std::putchar(c);
+    }
+}
+
+}   //namespace sim
@@ -0,0 +1,152 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIMWORLD_HPP
+#define SIMWORLD_HPP
+
+#include "hwlib.hpp"
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+/// @file
+
+namespace sim {
+
+/// @brief Thrown by the time functions when the end of the simulation is reached, it unwinds the firmware back to the simulator.
+struct finished {};
+
+/// @brief What things cost on the Due, in ns of virtual time.
+struct costs {
+    static constexpr uint64_t nowUs     = 1000;     ///< Reading the clock.
+    static constexpr uint64_t spiByte   = 8000;     ///< One byte on the bit banged SPI bus.
+    static constexpr uint64_t i2cByte   = 90000;    ///< One byte on the bit banged I2C bus, about 100 kHz.
+    static constexpr uint64_t uartChar  = 86806;    ///< One character at 115200 baud, hwlib::cout waits for the uart.
+};
+
+/// @brief A chip on the SPI bus, selected by its own pin.
+class spiDevice {
+public:
+    virtual ~spiDevice(){}
+
+    /// @brief One transaction, select low for all n bytes.
+    virtual void transfer(size_t n, const uint8_t out[], uint8_t in[]) = 0;
+};
+
+/// @brief A chip on the I2C bus.
+class i2cDevice {
+public:
+    virtual ~i2cDevice(){}
+
+    /// @brief Start condition and address byte.
+    virtual void begin(bool reading) = 0;
+    virtual void write(uint8_t byte) = 0;
+    virtual uint8_t read() = 0;
+
+    /// @brief Stop condition.
+    virtual void stop(){}
+};
+
+/// @brief Sees every transaction on the buses, for the bus traces.
+class busObserver {
+public:
+    const static uint8_t spiWrite   = 0;    /// @brief Bytes written to a register, target is the register.
+    const static uint8_t spiRead    = 1;    /// @brief Bytes read from a register, target is the register.
+    const static uint8_t i2cWrite   = 2;    /// @brief Bytes written to a chip, target is the 7 bit address.
+    const static uint8_t i2cRead    = 3;    /// @brief Bytes read from a chip, target is the 7 bit address.
+
+    virtual ~busObserver(){}
+
+    /// @brief One transaction, data is what was written or what was read.
+    virtual void transaction(uint8_t kind, uint8_t target, const uint8_t data[], size_t n, uint64_t time) = 0;
+};
+
+/// @brief
+/// The world around the simulated Due
+/// @detail
+/// Keeps the virtual time in ns and the events that happen at a certain time, like a card that is put on the reader.
+/// Events run as soon as the firmware lets time pass beyond them. The pins and buses of the sim hwlib end up here.
+class world {
+private:
+    struct event {
+        uint64_t time;
+        uint64_t order;
+        std::function< void() > action;
+        bool operator>(const event & other) const { return time != other.time ? time > other.time : order > other.order; }
+    };
+
+    uint64_t time = 0;
+    uint64_t endTime = UINT64_MAX;
+    uint64_t events = 0;
+    std::priority_queue< event, std::vector< event >, std::greater< event > > queue;
+    std::vector< std::function< void(uint64_t) > > tickers;
+
+    static constexpr size_t pinCount = size_t(hwlib::target::pins::amount);
+    bool outputs[pinCount] = {};
+    bool inputs[pinCount] = {};
+    std::vector< std::function< void(bool) > > observers[pinCount];
+    spiDevice * spi[pinCount] = {};
+    i2cDevice * i2c[128] = {};
+    busObserver * observer = nullptr;
+public:
+    /// @brief Everything the firmware sent over the serial port.
+    std::string serial;
+
+    /// @brief Copy the serial output to stdout while it is sent.
+    bool echo = false;
+
+    /// @brief The world the sim hwlib uses, there is one Due.
+    static world & current();
+
+    /// @brief Virtual time in ns since power on.
+    uint64_t now() const { return time; }
+
+    /// @brief Let time pass, the events that are due run.
+    void advance(uint64_t ns);
+
+    /// @brief Stop the firmware at the next time function after this moment.
+    void end(uint64_t at){ endTime = at; }
+
+    /// @brief Throws finished when the end is reached.
+    void checkEnd() const;
+
+    /// @brief Run an action at a moment, right away when the moment has passed.
+    void at(uint64_t moment, std::function< void() > action);
+
+    /// @brief Called with the time every time it changes, for hardware that counts by itself.
+    void onAdvance(std::function< void(uint64_t) > ticker){ tickers.push_back(ticker); }
+
+    void pinWrite(hwlib::target::pins pin, bool value);
+    bool pinRead(hwlib::target::pins pin) const { return inputs[size_t(pin)]; }
+    bool output(hwlib::target::pins pin) const { return outputs[size_t(pin)]; }
+
+    /// @brief Level the firmware reads on an input.
+    void setInput(hwlib::target::pins pin, bool value){ inputs[size_t(pin)] = value; }
+
+    /// @brief Called every time the firmware changes an output. A pin can have more observers, like a shared reset pin.
+    void observe(hwlib::target::pins pin, std::function< void(bool) > observer){ observers[size_t(pin)].push_back(observer); }
+
+    void connect(hwlib::target::pins select, spiDevice & device){ spi[size_t(select)] = &device; }
+    void connect(uint8_t address, i2cDevice & device){ i2c[address & 0x7F] = &device; }
+    spiDevice * spiAt(hwlib::target::pins select) const { return spi[size_t(select)]; }
+    i2cDevice * i2cAt(uint8_t address) const { return i2c[address & 0x7F]; }
+
+    /// @brief Let an observer see the buses, nullptr for none.
+    void watch(busObserver * newObserver){ observer = newObserver; }
+
+    void busTransaction(uint8_t kind, uint8_t target, const uint8_t data[], size_t n){
+        if(observer != nullptr){
+            observer->transaction(kind, target, data, n, time);
+        }
+    }
+
+    void serialPut(char c);
+};
+
+}   //namespace sim
+
+#endif //SIMWORLD_HPP
@@ -0,0 +1,120 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// A base station in readout mode on a pty, to test liveResults without hardware.
+// usage: stationSim [-o capture] event.txt [cards per minute] [cards]
+// Prints the path of the pty and then sends readout frames of made up cards on the first course of the event file, with
+// random times and now and then a missing control, mixed with the text the station prints. With -o the same bytes go to a file as well.
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "resultsEngine.hpp"
+
+//writes to the pty and the capture
+class ptySink : public byteSink {
+public:
+    int pty;
+    std::FILE * capture = nullptr;
+    std::string pending;
+
+    void put(uint8_t byte) override {
+        pending += char(byte);
+    }
+
+    void text(const char * line){
+        pending += line;
+    }
+
+    void send(){
+        size_t done = 0;
+        while(done < pending.size()){
+            ssize_t length = write(pty, pending.data() + done, pending.size() - done);
+            if(length <= 0){
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            done += length;
+        }
+        if(capture != nullptr){
+            std::fwrite(pending.data(), 1, pending.size(), capture);
+            std::fflush(capture);
+        }
+        pending.clear();
+    }
+};
+
+int main(int argc, char ** argv){
+    int arg = 1;
+    const char * capturePath = nullptr;
+    if(argc > 2 && std::strcmp(argv[1], "-o") == 0){
+        capturePath = argv[2];
+        arg = 3;
+    }
+    if(argc <= arg){
+        std::fprintf(stderr, "usage: %s [-o capture] event.txt [cards per minute] [cards]\n", argv[0]);
+        return 1;
+    }
+    resultsEngine event;
+    if(!event.loadEvent(argv[arg])){
+        return 1;
+    }
+    double perMinute = argc > arg + 1 ? std::atof(argv[arg + 1]) : 60;
+    size_t amount = argc > arg + 2 ? std::strtoul(argv[arg + 2], nullptr, 10) : 100;
+
+    ptySink sink;
+    sink.pty = posix_openpt(O_RDWR | O_NOCTTY);
+    if(sink.pty < 0 || grantpt(sink.pty) != 0 || unlockpt(sink.pty) != 0){
+        std::perror("pty");
+        return 1;
+    }
+    //raw, otherwise the line discipline changes bytes of the frames; the slave stays open so the reader never sees a hang up
+    int slave = open(ptsname(sink.pty), O_RDWR | O_NOCTTY);
+    termios settings;
+    tcgetattr(slave, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(slave, TCSANOW, &settings);
+    if(capturePath != nullptr){
+        sink.capture = std::fopen(capturePath, "wb");
+    }
+    std::printf("%s\n", ptsname(sink.pty));
+    std::fflush(stdout);
+
+    std::mt19937 random(7);
+    frameWriter frame(sink);
+    sink.text("Uitlezen\nWachten op nieuwe kaart \n");
+    for(size_t n = 0; n < amount; n++){
+        //made up cards run the first course, with one course in the event file liveResults ranks them on it
+        std::vector<uint8_t> controls = event.courses().empty() ? std::vector<uint8_t>{} : event.courses()[0].controls;
+        uint32_t uid = random();
+        cardUID card(uid & 0xFF, (uid >> 8) & 0xFF, (uid >> 16) & 0xFF, uid >> 24);
+        std::vector<punchRecord> punches;
+        uint32_t time = 1000000;
+        for(uint8_t control : controls){
+            time += 30 + random() % 300;
+            if(random() % 20 != 0){
+                punches.push_back({control, time, uint16_t(random() % 32768)});
+            }
+        }
+        frame.begin(readoutFrame::readoutType, card, readoutFrame::readoutHeaderSize + punches.size() * readoutFrame::punchSize);
+        frame.add32(1000000);
+        frame.add(punchLog::deltaVersion);
+        frame.add(punches.size());
+        for(const punchRecord & punch : punches){
+            frame.addPunch(punch);
+        }
+        frame.end();
+        sink.send();
+        std::this_thread::sleep_for(std::chrono::duration<double>(60.0 / perMinute));
+    }
+    sink.text("klaar\n");
+    sink.send();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));   //let the reader empty the pty
+    return 0;
+}
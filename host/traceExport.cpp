@@ -0,0 +1,167 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// Turns the trace frames in the serial output of a station built with -DSTATION_TRACE into something to look at.
+// usage: traceExport [summary|chrome|folded] serial
+//   summary  per span the count, total and self time (without the spans inside it), average and maximum
+//   chrome   a timeline in the Chrome trace event format, open it in chrome://tracing or ui.perfetto.dev
+//   folded   the self time in us per stack, the input of flamegraph.pl or speedscope
+// make trace runs the steady scenario on a traced virtual station and writes all three.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "readoutFrame.hpp"
+#include "stationTrace.hpp"
+
+static const char * spanName(uint8_t id){
+    switch(id){
+#define STATION_TRACE_NAME(name, id, text) case id: return text;
+        STATION_TRACE_SPANS(STATION_TRACE_NAME)
+#undef STATION_TRACE_NAME
+    }
+    return "?";
+}
+
+struct spanStats {
+    uint32_t count = 0;
+    double total = 0;
+    double self = 0;
+    double max = 0;
+};
+
+struct openSpan {
+    uint8_t id;
+    double start;
+    double children;
+};
+
+//rebuilds the spans out of the begin and end events
+class spanBuilder {
+private:
+    std::vector< openSpan > stack;
+    uint64_t time = 0;
+    uint32_t previous = 0;
+    bool first = true;
+    bool comma = false;
+
+    std::string path() const {
+        std::string text;
+        for(auto & span : stack){
+            text += text.empty() ? "" : ";";
+            text += spanName(span.id);
+        }
+        return text;
+    }
+public:
+    bool chrome = false;
+    std::map< uint8_t, spanStats > stats;
+    std::map< std::string, double > folded;
+    uint32_t unmatched = 0;
+
+    //time in us, the 32 bit clock is unwrapped: events come in order and close together
+    void event(uint8_t span, uint32_t ticks, uint32_t rate){
+        time += first ? 0 : uint32_t(ticks - previous);
+        previous = ticks;
+        first = false;
+        double now = double(time) * 1e6 / rate;
+        uint8_t id = span & ~stationTrace::endFlag;
+        if(!(span & stationTrace::endFlag)){
+            stack.push_back({id, now, 0});
+            return;
+        }
+        size_t at = stack.size();
+        while(at > 0 && stack[at - 1].id != id){
+            at--;
+        }
+        if(at == 0){
+            unmatched++;
+            return;
+        }
+        stack.resize(at);       //spans that were not ended are forgotten
+        openSpan done = stack.back();
+        double duration = now - done.start;
+        folded[path()] += duration - done.children;
+        stack.pop_back();
+        if(!stack.empty()){
+            stack.back().children += duration;
+        }
+        spanStats & entry = stats[id];
+        entry.count++;
+        entry.total += duration;
+        entry.self += duration - done.children;
+        entry.max = duration > entry.max ? duration : entry.max;
+        if(chrome){
+            std::printf("%s\n  {\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": 1}",
+                        comma ? "," : "", spanName(id), done.start, duration);
+            comma = true;
+        }
+    }
+};
+
+int main(int argc, char ** argv){
+    const char * mode = argc == 3 ? argv[1] : "summary";
+    if((argc != 2 && argc != 3) || (std::strcmp(mode, "summary") != 0 && std::strcmp(mode, "chrome") != 0 && std::strcmp(mode, "folded") != 0)){
+        std::fprintf(stderr, "usage: %s [summary|chrome|folded] serial\n", argv[0]);
+        return 1;
+    }
+    std::FILE * in = std::fopen(argv[argc - 1], "rb");
+    if(in == nullptr){
+        std::perror(argv[argc - 1]);
+        return 1;
+    }
+
+    spanBuilder spans;
+    spans.chrome = std::strcmp(mode, "chrome") == 0;
+    if(spans.chrome){
+        std::printf("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    }
+    static frameParser parser;
+    uint32_t frames = 0, events = 0;
+    int c;
+    auto take = [&](){
+        if(parser.type() != readoutFrame::traceType || parser.payloadLength() < 4){
+            return;
+        }
+        const uint8_t * p = parser.payload();
+        auto number = [p](uint16_t at){ return uint32_t(p[at]) | (uint32_t(p[at + 1]) << 8) | (uint32_t(p[at + 2]) << 16) | (uint32_t(p[at + 3]) << 24); };
+        uint32_t rate = number(0);
+        for(uint16_t at = 4; at + stationTrace::eventSize <= parser.payloadLength(); at += stationTrace::eventSize){
+            spans.event(p[at], number(at + 1), rate);
+            events++;
+        }
+        frames++;
+    };
+    while((c = std::getc(in)) != EOF){
+        for(bool frame = parser.feed(uint8_t(c)); frame; frame = parser.next()){
+            take();
+        }
+    }
+    while(parser.end()){
+        take();
+    }
+    std::fclose(in);
+
+    if(spans.chrome){
+        std::printf("\n]}\n");
+    }else if(std::strcmp(mode, "folded") == 0){
+        for(auto & stack : spans.folded){
+            std::printf("%s %.0f\n", stack.first.c_str(), stack.second);
+        }
+    }else{
+        std::printf("%-14s %8s %12s %12s %10s %10s\n", "span", "count", "total ms", "self ms", "avg us", "max us");
+        for(auto & entry : spans.stats){
+            const spanStats & span = entry.second;
+            std::printf("%-14s %8" PRIu32 " %12.3f %12.3f %10.1f %10.1f\n", spanName(entry.first), span.count,
+                        span.total / 1000, span.self / 1000, span.total / span.count, span.max);
+        }
+    }
+    std::fprintf(stderr, "%" PRIu32 " trace frames, %" PRIu32 " events, %" PRIu32 " ends without a begin, %" PRIu32 " bad frames\n",
+                 frames, events, spans.unmatched, parser.badFrames);
+    return parser.badFrames == 0 ? 0 : 2;
+}
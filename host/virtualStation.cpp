@@ -0,0 +1,464 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+// A whole post station in virtual time: main.cpp and the drivers run unchanged against the sim hwlib in sim/,
+// with a simulated MFRC522, MIFARE cards and DS1307. Runners from a scenario file put their card on the reader one by one.
+// usage: virtualStation [-v] [-o serial] scenario.txt
+// With -v the serial output of the station is printed while it runs, with -o it is written to a file.
+//
+// The scenario has one command per line, times of arrivals are seconds since power on:
+//   reaction <ms>                      the runner takes the card away this long after the beep
+//   handover <ms>                      time between one card leaving the reader and the next one on it
+//   giveup <ms>                        the runner leaves without a beep after this long
+//   hold <ms>                          every card stays this long on the reader, beep or not (0: until the beep)
+//   again <percent> <ms>               share of the runners that put their card back this long after taking it away
+//   seed <n>                           for the choice of the runners that come back
+//   marginal <percent>                 share of the answers of every card that get lost, a card held at the edge of the field
+//   readers <n>                        card readers side by side, 1 to 4, a runner takes the first free one
+//   steady <count> <start> <ms>        runners one after another
+//   mass <count> <start>               runners that all arrive at the same moment
+//   bunch <groups> <size> <start> <s>  groups that arrive together, one group every s seconds
+//   restart <s>                        the Due restarts at this moment (watchdog, brown-out), the chips keep running
+//   end <s>                            stop the simulation, otherwise it stops when the last runner is done
+//
+// The report has the boot time of every start (power on to the first search for a card), the queue wait (arrival to card on the reader), the punch latency (card on the reader to the last
+// block of the punch written) and the feedback latency (card on the reader to the beep), and how many runners the post can handle.
+// The share of the time the field of the reader was on is what the battery of the post mostly goes to.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "sim/simWorld.hpp"
+#include "sim/simMFRC522.hpp"
+#include "sim/simDS1307.hpp"
+#include "readoutFrame.hpp"
+#include "DS1307.hpp"
+#include "stationTrace.hpp"
+
+int stationMain();
+
+#ifdef STATION_TRACE
+//the spans read the virtual time without spending any and without ending the simulation in a destructor,
+//so the traced station does exactly what the untraced one does
+class virtualClock : public tickSource {
+public:
+    uint32_t ticks() override { return uint32_t(sim::world::current().now() / 1000); }
+    uint32_t rate() const override { return 1000000; }
+};
+#endif
+
+using hwlib::target::pins;
+
+const uint64_t ms = 1000000;
+const uint64_t second = 1000 * ms;
+
+struct scenario {
+    uint64_t reaction = 300 * ms;
+    uint64_t handover = 1500 * ms;
+    uint64_t giveup = 5 * second;
+    uint64_t hold = 0;
+    uint32_t againPercent = 0;
+    uint64_t againDelay = 2 * second;
+    uint32_t seed = 1;
+    uint32_t lossPercent = 0;
+    uint32_t readers = 1;
+    uint64_t end = 0;
+    std::vector< uint64_t > arrivals;
+    std::vector< uint64_t > restarts;
+
+    bool load(const char * path){
+        std::ifstream file(path);
+        if(!file){
+            std::fprintf(stderr, "can't open %s\n", path);
+            return false;
+        }
+        std::string line;
+        size_t number = 0;
+        while(std::getline(file, line)){
+            number++;
+            std::istringstream words(line);
+            std::string command;
+            if(!(words >> command) || command[0] == '#'){
+                continue;
+            }
+            double a = 0, b = 0, c = 0, d = 0;
+            bool ok = true;
+            if(command == "reaction"){
+                ok = bool(words >> a);
+                reaction = a * ms;
+            }else if(command == "handover"){
+                ok = bool(words >> a);
+                handover = a * ms;
+            }else if(command == "giveup"){
+                ok = bool(words >> a);
+                giveup = a * ms;
+            }else if(command == "hold"){
+                ok = bool(words >> a);
+                hold = a * ms;
+            }else if(command == "again"){
+                ok = bool(words >> a >> b);
+                againPercent = a;
+                againDelay = b * ms;
+            }else if(command == "marginal"){
+                ok = bool(words >> a);
+                lossPercent = a;
+            }else if(command == "readers"){
+                ok = bool(words >> a) && a >= 1 && a <= 4;
+                readers = a;
+            }else if(command == "seed"){
+                ok = bool(words >> a);
+                seed = a;
+            }else if(command == "steady"){
+                ok = bool(words >> a >> b >> c);
+                for(uint32_t i = 0; i < uint32_t(a); i++){
+                    arrivals.push_back(b * second + i * c * ms);
+                }
+            }else if(command == "mass"){
+                ok = bool(words >> a >> b);
+                arrivals.insert(arrivals.end(), size_t(a), uint64_t(b * second));
+            }else if(command == "bunch"){
+                ok = bool(words >> a >> b >> c >> d);
+                for(uint32_t group = 0; group < uint32_t(a); group++){
+                    arrivals.insert(arrivals.end(), size_t(b), uint64_t((c + group * d) * second));
+                }
+            }else if(command == "restart"){
+                ok = bool(words >> a);
+                restarts.push_back(a * second);
+            }else if(command == "end"){
+                ok = bool(words >> a);
+                end = a * second;
+            }else{
+                ok = false;
+            }
+            if(!ok){
+                std::fprintf(stderr, "%s:%zu: can't use '%s'\n", path, number, line.c_str());
+                return false;
+            }
+        }
+        std::stable_sort(arrivals.begin(), arrivals.end());
+        std::sort(restarts.begin(), restarts.end());
+        return true;
+    }
+};
+
+//one time a runner puts a card on the reader
+struct visit {
+    size_t runner;
+    uint64_t arrival;
+    bool comesBack;
+    uint64_t placed = 0;
+    uint64_t removed = 0;
+    uint64_t feedback = 0;
+    uint64_t punched = 0;
+};
+
+//the runners in front of the post, one card on every reader at a time, the first runner in the queue takes the first free reader
+class queue {
+private:
+    struct reader {
+        sim::chip & rfid;
+        long current = -1;
+        uint64_t freeAt = 0;
+        bool nextPlanned = false;
+    };
+
+    sim::world & due;
+    std::vector< reader > readers;
+    const scenario & plan;
+    std::deque< size_t > waiting;
+    size_t left = 0;
+
+    void next(size_t r){
+        reader & place = readers[r];
+        if(place.current >= 0 || waiting.empty() || place.nextPlanned){
+            return;
+        }
+        if(due.now() < place.freeAt){     //the previous runner is still getting out of the way
+            place.nextPlanned = true;
+            due.at(place.freeAt, [this, r]{ readers[r].nextPlanned = false; next(r); });
+            return;
+        }
+        size_t number = waiting.front();
+        waiting.pop_front();
+        place.current = number;
+        visits[number].placed = due.now();
+        place.rfid.place(&cards[visits[number].runner]);
+        uint64_t limit = plan.hold ? plan.hold : plan.giveup;
+        due.at(due.now() + limit, [this, r, number]{
+            if(readers[r].current == long(number)){
+                remove(r);
+            }
+        });
+    }
+
+    void remove(size_t r){
+        reader & place = readers[r];
+        visit & runner = visits[place.current];
+        runner.removed = due.now();
+        for(uint64_t written : cards[runner.runner].writes){   //the last write of the punch
+            if(written >= runner.placed && written <= runner.removed){
+                runner.punched = written;
+            }
+        }
+        place.rfid.place(nullptr);
+        place.current = -1;
+        place.freeAt = due.now() + plan.handover;
+        if(runner.comesBack){
+            arrive({runner.runner, due.now() + plan.againDelay, false});
+        }
+        if(--left == 0){
+            finish = plan.end ? plan.end : due.now() + second;
+            due.end(std::min(finish, restart));
+        }
+        next(r);
+    }
+public:
+    std::vector< sim::card > cards;
+    std::vector< visit > visits;
+    uint64_t finish = UINT64_MAX;   ///< End of the simulation.
+    uint64_t restart = UINT64_MAX;  ///< Next restart of the Due.
+
+    queue(sim::world & due, std::deque< sim::chip > & chips, const scenario & plan):
+        due( due ),
+        plan( plan )
+    {
+        for(auto & rfid : chips){
+            readers.push_back({rfid});
+        }
+    }
+
+    void arrive(const visit & runner){
+        size_t number = visits.size();
+        visits.push_back(runner);
+        left++;
+        due.at(runner.arrival, [this, number]{
+            waiting.push_back(number);
+            for(size_t r = 0; r < readers.size(); r++){
+                next(r);
+            }
+        });
+    }
+
+    //the beeps come in the order the cards were written, a beep without a written card is for the card that waits longest
+    void beep(bool on){
+        if(!on){
+            return;
+        }
+        long chosen = -1;
+        uint64_t chosenWritten = 0;
+        for(size_t r = 0; r < readers.size(); r++){
+            long number = readers[r].current;
+            if(number < 0 || visits[number].feedback != 0){
+                continue;
+            }
+            const visit & runner = visits[number];
+            uint64_t written = 0;
+            for(uint64_t moment : cards[runner.runner].writes){
+                if(moment >= runner.placed){
+                    written = moment;
+                    break;
+                }
+            }
+            bool better = chosen < 0;
+            if(!better && written != 0){
+                better = chosenWritten == 0 || written < chosenWritten;
+            }else if(!better && chosenWritten == 0){
+                better = runner.placed < visits[readers[chosen].current].placed;
+            }
+            if(better){
+                chosen = long(r);
+                chosenWritten = written;
+            }
+        }
+        if(chosen < 0){
+            return;
+        }
+        size_t r = size_t(chosen);
+        size_t number = readers[r].current;
+        visits[number].feedback = due.now();
+        if(plan.hold == 0){
+            due.at(due.now() + plan.reaction, [this, r, number]{
+                if(readers[r].current == long(number)){
+                    remove(r);
+                }
+            });
+        }
+    }
+};
+
+//the station is ready for a card at the first search, the first time the MFRC522 is told to send after a start
+class bootWatch : public sim::busObserver {
+public:
+    uint64_t started = 0;
+    bool waiting = false;
+    std::vector< double > times;
+
+    void start(uint64_t now){
+        started = now;
+        waiting = true;
+    }
+
+    void transaction(uint8_t kind, uint8_t target, const uint8_t data[], size_t n, uint64_t time) override {
+        if(waiting && kind == spiWrite && target == 0x01 && n > 0 && (data[0] & 0x0F) == 0x0C){     //CommandReg, Transceive
+            times.push_back(double(time - started) / ms);
+            waiting = false;
+        }
+    }
+};
+
+static void distribution(const char * name, std::vector< double > values){
+    if(values.empty()){
+        std::printf("%-18s -\n", name);
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    auto at = [&](double share){ return values[std::min(values.size() - 1, size_t(share * values.size()))]; };
+    std::printf("%-18s min %8.1f  p50 %8.1f  p90 %8.1f  p99 %8.1f  max %8.1f ms\n", name,
+                values.front(), at(0.5), at(0.9), at(0.99), values.back());
+}
+
+int main(int argc, char ** argv){
+    sim::world & due = sim::world::current();
+    const char * serialPath = nullptr;
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-'; arg++){
+        if(std::strcmp(argv[arg], "-v") == 0){
+            due.echo = true;
+        }else if(std::strcmp(argv[arg], "-o") == 0 && arg + 1 < argc){
+            serialPath = argv[++arg];
+        }else{
+            break;
+        }
+    }
+    scenario plan;
+    if(arg + 1 != argc){
+        std::fprintf(stderr, "usage: %s [-v] [-o serial] scenario.txt\n", argv[0]);
+        return 1;
+    }
+    if(!plan.load(argv[arg])){
+        return 1;
+    }
+    if(plan.arrivals.empty()){
+        std::fprintf(stderr, "%s has no runners\n", argv[arg]);
+        return 1;
+    }
+
+    const uint8_t powerOn[7] = {3, 1, 6, 70, 10, 0, 0};     //1/6/2022 10:00:00
+    sim::rtc clock(due, DS1307::tijdstip_van_datum(powerOn));
+    const pins selects[4] = {pins::d8, pins::d7, pins::d6, pins::d5};    //the SDA pins of main.cpp, one reset pin
+    std::deque< sim::chip > readers;
+    for(uint32_t i = 0; i < plan.readers; i++){
+        readers.emplace_back(due, selects[i], pins::d12);
+    }
+    due.setInput(pins::d28, false);     //post operation
+
+    queue field(due, readers, plan);
+    std::mt19937 random(plan.seed);
+    field.cards.reserve(plan.arrivals.size());
+    field.visits.reserve(2 * plan.arrivals.size());     //visits of runners that come back are added while it runs
+    for(size_t i = 0; i < plan.arrivals.size(); i++){
+        field.cards.emplace_back(cardUID(0x04, uint8_t(i >> 16), uint8_t(i >> 8), uint8_t(i)));
+        field.cards.back().lossPercent = plan.lossPercent;
+        field.cards.back().noise = plan.seed + i;
+        punchLog log(field.cards.back());
+        log.start(clock.seconds(0) - 1800);     //started half an hour before the post was switched on
+        bool comesBack = random() % 100 < plan.againPercent;
+        field.arrive({i, plan.arrivals[i], comesBack});
+    }
+    due.observe(pins::d22, [&field](bool on){ field.beep(on); });
+    if(plan.end){
+        field.finish = plan.end;
+    }
+    bootWatch boot;
+    due.watch(&boot);
+
+#ifdef STATION_TRACE
+    static virtualClock traceClock;
+    stationTrace::useClock(traceClock);
+#endif
+    for(size_t restart = 0;; restart++){
+        field.restart = restart < plan.restarts.size() ? plan.restarts[restart] : UINT64_MAX;
+        due.end(std::min(field.finish, field.restart));
+        boot.start(due.now());
+        try {
+            stationMain();
+        } catch(const sim::finished &){
+        }
+        if(due.now() >= field.finish || field.restart == UINT64_MAX){
+            break;
+        }
+    }
+    due.watch(nullptr);
+
+    if(serialPath != nullptr){
+        std::ofstream(serialPath, std::ios::binary).write(due.serial.data(), due.serial.size());
+    }
+    frameParser parser;
+    size_t journal = 0;
+    for(char c : due.serial){
+        for(bool frame = parser.feed(uint8_t(c)); frame; frame = parser.next()){
+            if(parser.type() == readoutFrame::punchType){
+                journal++;
+            }
+        }
+    }
+    while(parser.end()){
+        if(parser.type() == readoutFrame::punchType){
+            journal++;
+        }
+    }
+
+    size_t punched = 0, duplicates = 0;
+    for(auto & card : field.cards){
+        punchLog log(card);
+        uint8_t count = log.open() == punchLog::OkStatus ? log.count() : 0;
+        punched += count > 0;
+        duplicates += count > 1 ? count - 1 : 0;
+    }
+    std::vector< double > wait, punch, feedback;
+    uint64_t service = 0, first = UINT64_MAX, last = 0;
+    size_t served = 0;
+    for(auto & runner : field.visits){
+        if(runner.placed == 0){
+            continue;   //still waiting at the end
+        }
+        wait.push_back(double(runner.placed - runner.arrival) / ms);
+        if(runner.punched){
+            punch.push_back(double(runner.punched - runner.placed) / ms);
+        }
+        if(runner.feedback){
+            feedback.push_back(double(runner.feedback - runner.placed) / ms);
+        }
+        if(runner.removed){
+            service += runner.removed - runner.placed + plan.handover;
+            served++;
+            last = std::max(last, runner.removed);
+        }
+        first = std::min(first, runner.arrival);
+    }
+
+    const size_t runners = field.cards.size();
+    std::printf("simulated %.1f s, %zu serial bytes, %zu journal frames\n", double(due.now()) / second, due.serial.size(), journal);
+    std::printf("runners %zu, punched %zu, duplicate punches %zu, missed %zu, visits %zu\n",
+                runners, punched, duplicates, runners - punched, field.visits.size());
+    uint64_t fieldTime = 0;
+    for(auto & rfid : readers){
+        fieldTime += rfid.fieldTime(due.now());
+    }
+    std::printf("field on %.1f%% of the time\n", 100.0 * fieldTime / readers.size() / due.now());
+    distribution("boot", boot.times);
+    distribution("queue wait", wait);
+    distribution("punch latency", punch);
+    distribution("feedback latency", feedback);
+    if(served > 0 && last > first){
+        std::printf("throughput %.1f runners/min, capacity %.1f runners/min (%.0f ms per card with handover)\n",
+                    double(served) * 60 * second / (last - first), 60.0 * second * served * readers.size() / service, double(service) / served / ms);
+    }
+    return runners == punched ? 0 : 2;
+}
@@ -3,126 +3,429 @@
 #include "hwlib.hpp"
 #include "MFRC522.hpp"
 #include "DS1307.hpp"
+#include "clockSync.hpp"
+#include "precisionTime.hpp"
+#include "punchLog.hpp"
+#include "cardStorage.hpp"
+#include "scheduler.hpp"
+#include "stationIO.hpp"
+#include "stationLog.hpp"
+#include "punchPipeline.hpp"
+#include "readerGroup.hpp"
+#include "pollSchedule.hpp"
+#include "deelnemers.hpp"
+#include "readoutFrame.hpp"
+#include "stationTrace.hpp"
 
-void biepen_goed(hwlib::target::pin_out & bieper_pin){
-    bieper_pin.write( 1 );
-    hwlib::wait_ms(500);
-    bieper_pin.write(0);
+const uint8_t post_nummer = 31; //nummer van deze post, per station instellen
+const uint32_t herhaal_venster = 60000; //ms waarin een kaart op deze post niet nog een keer gestempeld wordt
+const bool binair_uitlezen = true; //uitlezen als binaire frames voor de computer, false voor tekst op een terminal
+const bool journaal_frames = true; //elke punch van een post ook als binair frame versturen, voor het samenvoegen na de wedstrijd
+const uint32_t stapel_budget = 8192; //bytes die de objecten van main op de stapel mogen gebruiken, de rest van de 96 kB RAM is voor caches en journalen
+const uint32_t statisch_budget = 4096; //bytes voor de statische buffers van de meldingen en de spans, naast de stapel
+const uint32_t actief_venster = 30000; //ms na de laatste kaart dat er zonder pauze naar kaarten gezocht wordt
+const uint32_t rust_interval = 250; //ms tussen twee zoekrondes op een stille post, de lezer slaapt ertussen. Langer spaart de batterij, korter laat de eerste loper minder wachten
+//een kaart die op de lezer blijft liggen wordt pas na het actief_venster weer gezien, bij het wakker worden na de eerste slaap
+const uint32_t vasthoud_venster = actief_venster + 2 * rust_interval; //ms waarin zo'n kaart weer gezien moet worden om niet opnieuw gestempeld te worden
+const uint8_t fractie_bits = 0; //bij de start: 0 voor hele seconden op de kaart, 10 voor milliseconden bij een sprint
+//sleutel A van elke sector, een nieuwe kaart heeft overal de standaard sleutel
+const uint8_t sleutels[cardStorage::sectors][6] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
+};
+
+void printen_tijd(hwlib::ostream & uit, uint32_t tijdstip, uint16_t ticks){ //print een tijd als dag/maand/jaar uren:minuten:secondes.milliseconden
+    uint8_t datum[7];
+    DS1307::datum_van_tijdstip(tijdstip, datum);
+    uit << int(datum[1]) << "/" << int(datum[2]) << "/" << int(datum[3])+1952 << " ";
+    uit << int(datum[4]) << ":" << int(datum[5]) << ":" << int(datum[6]) << "." << int((uint32_t(ticks) * 1000) >> 15) << "\n";
 }
 
-void biepen_start(hwlib::target::pin_out & bieper_pin){
-    for (int x = 0; x < 3; x++){
-        bieper_pin.write( 1 );
-        hwlib::wait_ms(500);
-        bieper_pin.write(0);
-        hwlib::wait_ms(500);
+void printen_loper(hwlib::ostream & uit, const uint8_t UID[5]){ //print de loper van een kaart, of dat de kaart onbekend is
+    const runner * loper = deelnemers.find(cardUID(UID));
+    if (loper == nullptr){
+        uit << "Onbekende kaart\n";
+    }else{
+        uit << int(loper->number) << " " << loper->name << " (" << loper->category << ")\n";
     }
-    bieper_pin.write( 1 );
-    hwlib::wait_ms(1000);
-    bieper_pin.write(0);
 }
 
-int main(){
-    //spi variabelen
-    auto miso = hwlib::target::pin_in(hwlib::target::pins::d11);
-    auto sclk = hwlib::target::pin_out(hwlib::target::pins::d9);
-    auto ss = hwlib::target::pin_out(hwlib::target::pins::d8);
-    auto mosi = hwlib::target::pin_out(hwlib::target::pins::d10);
-    auto reset = hwlib::target::pin_out(hwlib::target::pins::d12);
-    spiSetup spibus(sclk, mosi, miso);
-    MFRC522 rfid(spibus, ss, reset);
-    //opstarten RC522 kaartlezer
-    rfid.initialize(); 
-    
-    //i2c variabelen
-    auto scl = hwlib::target::pin_oc(hwlib::target::pins::scl);
-    auto sda = hwlib::target::pin_oc(hwlib::target::pins::sda);
-    hwlib::i2c_bus_bit_banged_scl_sda bus(scl, sda);
-    DS1307 rtc(bus);
+//de stationslogica als taak: elke keer dat de taak draait wordt een keer naar een kaart gezocht,
+//zodat biepen, knoppen en de seriele uitvoer gewoon doorgaan terwijl er op een kaart gewacht wordt
+class station_taak : public task {
+private:
+    DS1307 & rtc;
+    clockSync & sync;
+    punchPipeline & pijplijn;
+    readerGroup & lezers;
+    pollSchedule & peilen;
+    hwlib::pin_in & switch_select;
+    button & knop_start;
+    button & knop_uitlezen;
+    beeper & bieper;
+    serialOut & uit;
 
-    //restvariabelen
+    enum class modus { geen, post, wachten, start, uitlezen, synckaart };
+    modus huidig = modus::geen;
     uint8_t UID[5] = {0x00};
-    uint8_t receivedData[64];
-    uint8_t * data_rtc;
-    
-    
-    auto switch_select = hwlib::target::pin_in(hwlib::target::pins::d28);
-    auto bieper_pin = hwlib::target::pin_out(hwlib::target::pins::d22);
-    auto knop_uitlezen = hwlib::target::pin_in(hwlib::target::pins::d24); //hoog als ingedrukt
-    auto knop_start = hwlib::target::pin_in(hwlib::target::pins::d26); //hoog als ingedrukt
-    
-    for (;;){    
-        if (switch_select.read() == 0){
-            hwlib::cout << "Postoperatie \n";
-            hwlib::cout << "Wachten op nieuwe kaart \n";
-            rfid.waitForUID(UID);
-
-            rfid.read_card(); //leest kaart
-            //uitlezen DS1307 real-time clock
-            data_rtc = rtc.uitlezen_bytes();
-            hwlib::cout << "default = "<<UID[0]<<"\n";
-            //klaarmaken array om terug te schrijven naar de kaart
-            int rtc_data_ptr = 0;
-            uint8_t sendData[64]; 
-            for (int x = 0; x < 64; x++){
-                if (receivedData[x] == UID[0]){
-                    if (rtc_data_ptr < 7){
-                        sendData[x]=data_rtc[rtc_data_ptr];
-                        rtc_data_ptr = rtc_data_ptr + 1;
-                    }else{
-                        sendData[x]=UID[0];
-                    }
-                }else{
-                    sendData[x]=receivedData[x];
-                }
-                hwlib::cout<<sendData[x]<<" - ";
+    bool kaart_gezien = false; //alleen de spans van een ronde met een kaart worden bewaard
+    uint16_t journaal_verloren = 0;
+
+    void wisselen(modus nieuw){ //meldt de nieuwe modus een keer, in plaats van elke ronde
+        if (nieuw == huidig){
+            return;
+        }
+        huidig = nieuw;
+        switch (huidig){
+            case modus::post: uit << "Postoperatie \nWachten op nieuwe kaart \n"; break;
+            case modus::wachten: uit << "Basisstation \nWachten op knop\n"; break;
+            case modus::start: uit << "Start\nWachten op kaart \n"; break;
+            case modus::uitlezen: uit << "Uitlezen\nWachten op nieuwe kaart \n"; break;
+            case modus::synckaart: uit << "Synckaart\nWachten op kaart \n"; break;
+            default: break;
+        }
+    }
+
+    void journaal(){ //de punch ook als frame naar de seriele poort, opgevangen is dat het journaal van deze post
+        if (uit.space() < readoutFrame::frameSize(readoutFrame::punchFrameSize)){
+            journaal_verloren++; //een half frame is niets waard, het hele frame valt weg en wordt gemeld
+            LOG_WARN(stationLog::journalDropped, journaal_verloren);
+            return;
+        }
+        frameWriter frame(uit);
+        frame.begin(readoutFrame::punchType, cardUID(UID), readoutFrame::punchFrameSize);
+        frame.addPunch(pijplijn.lastPunch());
+        frame.add(pijplijn.status());
+        frame.end();
+    }
+
+    void post(){
+        uint8_t resultaat = pijplijn.run(lezers, UID); //alle lezers van de post zoeken tegelijk
+        if (resultaat == punchPipeline::NoCard){
+            return;
+        }
+        kaart_gezien = true;
+        TRACE_BEGIN(feedback);
+        if (journaal_frames && (resultaat == punchPipeline::Punched || resultaat == punchPipeline::WriteFailed)){
+            journaal();
+        }
+        const preciseTime & stempel = pijplijn.time();
+        if (resultaat == punchPipeline::AlreadyPunched){
+            bieper.play(beeper::good); //de loper ziet gewoon dat de kaart gestempeld is
+            uit << "Kaart al gestempeld\n";
+        }else if (resultaat == punchPipeline::SyncCard){
+            //synckaart van het basisstation, de DS1307 zelf wordt niet aangepast
+            sync.applySync(pijplijn.syncBlock(), stempel.seconds);
+            uint8_t sync_staat[clockSync::stateSize];
+            sync.save(sync_staat);
+            rtc.schrijven_ram(0, sync_staat, clockSync::stateSize);
+            bieper.play(beeper::good);
+            uit << "Klok gesynchroniseerd, verschil: " << int(sync.offset()) << " s, drift: " << int(sync.driftPpb()) << " ppb\n";
+        }else if (resultaat == punchPipeline::Punched){
+            //tijd gecorrigeerd met de laatste synckaart
+            const punchRecord & punch = pijplijn.lastPunch();
+            bieper.play(beeper::good);
+            uit << "Kaart geschreven! Punch " << int(pijplijn.count()) << ", nog " << int(pijplijn.freeBytes()) << " bytes vrij\n";
+            const cardStorage & gebruikt = lezers.storage(pijplijn.reader());
+            if (lezers.size() > 1){
+                uit << "Lezer " << int(pijplijn.reader() + 1) << ": ";
             }
-            
-            rfid.write(sendData, 64); //terugschrijven van array met data
-            for (int r = 0; r < 64; r++){
-                receivedData[r] = sendData[r];
+            uit << int(gebruikt.reads) << " blok gelezen, " << int(gebruikt.writes) << " geschreven, " << int(gebruikt.authentications) << " keer geauthenticeerd\n";
+            if (gebruikt.retry.saved > 0 || gebruikt.retry.failed > 0){ //sinds het opstarten, kaarten op de rand van het veld
+                uit << "Herhalingen: " << int(gebruikt.retry.saved) << " keer gered, " << int(gebruikt.retry.failed) << " keer opgegeven\n";
             }
-            hwlib::cout<<"Kaart geschreven!\n";
-            biepen_goed(bieper_pin);
-            //ontvangen/uitlezen data
-            rtc.uitlezen();
+            printen_tijd(uit, punch.seconds, punch.ticks);
+            uit << "+/- " << int((uint32_t(stempel.errorTicks) * 1000) >> 15) << " ms\n";
+            pijplijn.print(uit);
+        }else if (resultaat == punchPipeline::WriteFailed){
+            bieper.play(beeper::error);
+            uit << "Kaart niet geschreven! Fout " << int(pijplijn.status()) << "\n";
+        }else{
+            bieper.play(beeper::error);
+            uit << "Kaart niet gelezen!\n";
+        }
+        TRACE_END(feedback);
+        //de kaart is gehalt, een kaart die blijft liggen wordt niet nog een keer gestempeld
+    }
 
-            for (int i = 0; i < 64; i++){
-                hwlib::cout <<"data: " << receivedData[i] <<"\n";
+    void uitlezen_binair(cardStorage & kaart){ //de hele kaart als een frame, zie readoutFrame
+        punchLog log(kaart);
+        frameWriter frame(uit);
+        uint8_t status = kaart.open(UID) ? log.open() : punchLog::ReadErr;
+        if (status != punchLog::OkStatus){
+            frame.begin(readoutFrame::errorType, cardUID(UID), 1);
+            frame.add(status);
+            frame.end();
+            return;
+        }
+        //de lengte staat vooraan, de punches gaan het frame in terwijl ze gelezen worden
+        frame.begin(readoutFrame::readoutType, cardUID(UID), readoutFrame::readoutHeaderSize + log.count() * readoutFrame::punchSize);
+        frame.add32(log.startTime());
+        frame.add(log.version());
+        frame.add(log.count());
+        punchRecord punch;
+        for (uint8_t i = 0; i < log.count(); i++){
+            if (log.readNext(punch) != punchLog::OkStatus){
+                punch = {0, 0, 0}; //post 0 is een punch die niet gelezen kon worden
             }
-        }else{
-            hwlib::cout << "Basisstation \n";
-            hwlib::cout << "Wachten op knop\n";
-            while ((knop_start.read() == 0) && (knop_uitlezen.read() == 0)){
-                hwlib::wait_ms(500);
+            frame.addPunch(punch);
+        }
+        frame.end();
+        bieper.play(beeper::good);
+    }
+
+    void basis(){ //het basisstation gebruikt alleen de eerste lezer
+        if (huidig == modus::geen || huidig == modus::post){
+            lezers.cancel(); //een zoekronde van de post zou run() anders nooit laten slapen
+            wisselen(modus::wachten);
+        }
+        bool start = knop_start.pressed();
+        bool uitlezen = knop_uitlezen.pressed();
+        if ((start || uitlezen) && knop_start.isDown() && knop_uitlezen.isDown()){
+            wisselen(modus::synckaart);
+        }else if (start){
+            wisselen(modus::start);
+        }else if (uitlezen){
+            wisselen(modus::uitlezen);
+        }
+        if (huidig == modus::wachten){
+            return;
+        }
+        if (huidig == modus::uitlezen && binair_uitlezen && uit.space() < readoutFrame::readoutSize(255)){
+            return; //eerst het vorige frame verder versturen, een half frame is niets waard
+        }
+        cardStorage & kaart = lezers.storage(0);
+        if (!lezers.reader(0).pollUID(UID)){
+            return;
+        }
+        kaart_gezien = true;
+
+        if (huidig == modus::synckaart){
+            uint8_t blok[16];
+            clockSync::makeSyncBlock(rtc.lezen_tijdstip(), blok);
+            if (kaart.open(UID) && kaart.writeBlock(0, blok)){
+                bieper.play(beeper::good);
+                uit << "Synckaart geschreven!\n";
+            }else{
+                uit << "Synckaart niet geschreven!\n";
             }
-            if (knop_start.read() == 1){
-                hwlib::cout << "Start\n";
-                hwlib::cout << "Wachten op kaart \n";
-                rfid.waitForUID(UID);
-                uint8_t sendData[64]; 
-                for (int x = 0; x < 64; x++){
-                    sendData[x]=UID[0];
+        }else if (huidig == modus::start){
+            punchLog log(kaart);
+            //de starttijd is het einde van het aftellen
+            if (kaart.open(UID) && log.start(rtc.lezen_tijdstip() + 4, punchLog::deltaVersion, fractie_bits) == punchLog::OkStatus){
+                bieper.play(beeper::start);
+                if (binair_uitlezen){
+                    frameWriter frame(uit);
+                    frame.begin(readoutFrame::startType, cardUID(UID), 4);
+                    frame.add32(log.startTime());
+                    frame.end();
                 }
-                rfid.write(sendData, 64);
-                for (int r = 0; r < 64; r++){
-                    receivedData[r] = sendData[r];
-                }
-                biepen_start(bieper_pin);
-                hwlib::cout << "START! \n";
-            
-            }else if (knop_uitlezen.read() == 1){
-                hwlib::cout << "Uitlezen\n";
-                hwlib::cout << "Wachten op nieuwe kaart \n";
-                rfid.waitForUID(UID);
-                for (int i = 0; i < 64; i++){
-                    hwlib::cout <<"data: " << receivedData[i] <<"\n";
+                printen_loper(uit, UID);
+                uit << "START over 4 seconden! \n";
+            }else{
+                uit << "Kaart niet geschreven!\n";
+            }
+        }else if (huidig == modus::uitlezen && binair_uitlezen){
+            uitlezen_binair(kaart);
+            kaart.close();
+            return; //blijft uitlezen, de volgende kaart kan gelezen worden terwijl dit frame nog verstuurd wordt
+        }else if (huidig == modus::uitlezen){
+            punchLog log(kaart);
+            //de blokken worden op volgorde gelezen, dus elke sector wordt maar een keer geauthenticeerd
+            if (kaart.open(UID) && log.open() == punchLog::OkStatus){
+                printen_loper(uit, UID);
+                uit << "Start: ";
+                printen_tijd(uit, log.startTime(), 0);
+                punchRecord punch;
+                for (uint8_t i = 0; i < log.count(); i++){
+                    if (log.readNext(punch) != punchLog::OkStatus){
+                        uit << "Punch " << int(i) << " niet gelezen\n";
+                        break;
+                    }
+                    uit << "Post " << int(punch.station) << " na " << int(punch.seconds - log.startTime()) << " s: ";
+                    printen_tijd(uit, punch.seconds, punch.ticks);
                 }
-        
             }else{
-                hwlib::cout << "Er is iets fout gegaan!";
+                uit << "Geen punches op de kaart\n";
             }
         }
-        hwlib::wait_ms(1500);
+        kaart.close();
+        wisselen(modus::wachten);
     }
-}
\ No newline at end of file
+
+public:
+    station_taak(DS1307 & rtc, clockSync & sync, punchPipeline & pijplijn, readerGroup & lezers,
+                 pollSchedule & peilen, hwlib::pin_in & switch_select, button & knop_start, button & knop_uitlezen, beeper & bieper, serialOut & uit):
+        rtc( rtc ), sync( sync ), pijplijn( pijplijn ), lezers( lezers ), peilen( peilen ),
+        switch_select( switch_select ), knop_start( knop_start ), knop_uitlezen( knop_uitlezen ), bieper( bieper ), uit( uit )
+        {}
+
+    uint32_t run() override {
+        if (!peilen.awake()){
+            return peilen.wake(); //de lezer sliep, eerst moet een kaart in het veld weer stroom hebben
+        }
+        TRACE_BEGIN(loop);
+        kaart_gezien = false;
+        switch_select.refresh();
+        if (switch_select.read() == 0){
+            wisselen(modus::post);
+            post();
+        }else{
+            basis();
+        }
+        TRACE_END(loop);
+        TRACE_COMMIT(kaart_gezien);
+        if (lezers.searching()){
+            return 0; //de lezers wachten nog op antwoord van een kaart, ondertussen draaien de andere taken
+        }
+        return peilen.next(kaart_gezien); //na een kaart meteen weer zoeken, op een stille post steeds langer slapen
+    }
+};
+
+//kalibreert de klok op de achtergrond: bij het opstarten kan er meteen gestempeld worden, in hele seconden tot de klok gekalibreerd is
+class kalibratie_taak : public task {
+private:
+    precisionClock & precisie;
+    serialOut & uit;
+    bool gestart = false;
+    bool klaar = false;
+public:
+    kalibratie_taak(precisionClock & precisie, serialOut & uit):
+        precisie( precisie ), uit( uit )
+        {}
+
+    uint32_t run() override {
+        if (!gestart){
+            gestart = true;
+            precisie.startCalibration();
+        }
+        if (precisie.calibrating()){
+            return precisie.calibrateStep(); //een paar ms de DS1307 lezen rond de verwachte secondewissel, daartussen draait de rest
+        }
+        if (klaar){
+            return 0xFFFFFFFF;
+        }
+        klaar = true;
+        if (precisie.isCalibrated()){
+            uit << "Klok gekalibreerd, +/- " << int((uint32_t(precisie.error()) * 1000) >> 15) << " ms\n";
+        }else{
+            uit << "Geen SQW/OUT signaal, tijden in hele seconden\n";
+        }
+        return 0xFFFFFFFF; //klaar, draait nog maar eens in de 71 minuten
+    }
+};
+
+//alle objecten van de post, ze staan samen op de stapel van main zodat het stapel budget over het geheel gecontroleerd wordt
+struct onderdelen {
+    //spi variabelen
+    hwlib::target::pin_in miso{hwlib::target::pins::d11};
+    hwlib::target::pin_out sclk{hwlib::target::pins::d9};
+    hwlib::target::pin_out ss{hwlib::target::pins::d8};
+    //tot vier kaartlezers naast elkaar voor een drukke finish, op dezelfde spi bus en reset met elk een eigen SDA pin
+    hwlib::target::pin_out ss_2{hwlib::target::pins::d7};
+    hwlib::target::pin_out ss_3{hwlib::target::pins::d6};
+    hwlib::target::pin_out ss_4{hwlib::target::pins::d5};
+    hwlib::target::pin_out mosi{hwlib::target::pins::d10};
+    hwlib::target::pin_out reset{hwlib::target::pins::d12};
+    spiSetup spibus{sclk, mosi, miso};
+    MFRC522 rfid{spibus, ss, reset};
+    MFRC522 rfid_2{spibus, ss_2, reset};
+    MFRC522 rfid_3{spibus, ss_3, reset};
+    MFRC522 rfid_4{spibus, ss_4, reset};
+    //de punchlog gebruikt alle datablokken van de kaart, de synckaart gebruikt het eerste blok net als de header van de punchlog
+    cardStorage kaart{rfid, sleutels};
+    cardStorage kaart_2{rfid_2, sleutels};
+    cardStorage kaart_3{rfid_3, sleutels};
+    cardStorage kaart_4{rfid_4, sleutels};
+    readerGroup lezers;
+
+    //i2c variabelen
+    hwlib::target::pin_oc scl{hwlib::target::pins::scl};
+    hwlib::target::pin_oc sda{hwlib::target::pins::sda};
+    hwlib::i2c_bus_bit_banged_scl_sda bus{scl, sda};
+    DS1307 rtc{bus};
+    //klokcorrectie staat in het RAM van de DS1307 zodat die een herstart overleeft
+    clockSync sync;
+    //SQW/OUT van de DS1307 op 32.768kHz, geteld door de timer op pin d31, voor tijden in delen van een seconde
+    dueTickCounter teller;
+    precisionClock precisie{rtc, teller};
+
+    hwlib::target::pin_in switch_select{hwlib::target::pins::d28};
+    hwlib::target::pin_out bieper_pin{hwlib::target::pins::d22};
+    hwlib::target::pin_in knop_uitlezen_pin{hwlib::target::pins::d24}; //hoog als ingedrukt
+    hwlib::target::pin_in knop_start_pin{hwlib::target::pins::d26}; //hoog als ingedrukt
+
+    //alles draait als taak naast elkaar, er wordt nergens meer gewacht
+    scheduler planner;
+    serialOut uit;
+    logOut logboek{uit};    //meldingen van de drivers als frames, de tekst staat in readoutDecode
+#ifdef STATION_TRACE
+    traceOut spans{uit};    //waar de tijd van een punch heen gaat, zie traceExport
+#endif
+    beeper bieper{bieper_pin};
+    button knop_start{knop_start_pin};
+    button knop_uitlezen{knop_uitlezen_pin};
+    //de tijd wordt uitgerekend terwijl de kaart geselecteerd wordt
+    punchPipeline pijplijn{precisie, teller, sync, post_nummer, herhaal_venster, vasthoud_venster};
+    //zoeken naar kaarten: snel zolang er lopers komen, daarna slaapt de lezer tussen de zoekrondes
+    pollSchedule peilen{lezers, {actief_venster, rust_interval}};
+    station_taak station{rtc, sync, pijplijn, lezers, peilen, switch_select, knop_start, knop_uitlezen, bieper, uit};
+    kalibratie_taak kalibratie{precisie, uit};
+};
+
+//de grote buffers op de stapel zijn de seriele uitvoer en de recente kaarten van de pijplijn
+static_assert(sizeof(onderdelen) <= stapel_budget, "de objecten van main passen niet meer in het stapel budget");
+//de buffers van de meldingen en de spans zijn statisch, ze staan niet op de stapel
+#ifdef STATION_TRACE
+static_assert(stationLog::staticSize + stationTrace::staticSize <= statisch_budget, "de buffers van het log en de spans passen niet meer in het statische budget");
+#else
+static_assert(stationLog::staticSize <= statisch_budget, "de buffer van het log past niet meer in het statische budget");
+#endif
+
+int main(){
+    uint_fast64_t opstart = hwlib::now_us();
+    onderdelen alles;
+    hwlib::pin_out * sda_pins[] = {&alles.ss, &alles.ss_2, &alles.ss_3, &alles.ss_4};
+    for (auto * sda : sda_pins){
+        sda->write(1); //niet geselecteerd, anders antwoorden er twee lezers tegelijk
+        sda->flush();
+    }
+    readerGroup & lezers = alles.lezers;
+    lezers.add(alles.rfid, alles.kaart);
+    lezers.add(alles.rfid_2, alles.kaart_2);
+    lezers.add(alles.rfid_3, alles.kaart_3);
+    lezers.add(alles.rfid_4, alles.kaart_4);
+    //opstarten RC522 kaartlezers, na een herstart van de Due zonder reset als de lezers nog ingesteld zijn. Lezers die er niet zijn vallen af
+    bool snel = lezers.initialize();
+    while (lezers.size() == 0){ //zonder lezer stempelt de post niets, dat moet bij het neerzetten al opvallen
+        hwlib::cout << "Geen kaartlezer gevonden!\n";
+        hwlib::wait_ms(1000);
+    }
+
+    uint8_t sync_staat[clockSync::stateSize];
+    alles.rtc.lezen_ram(0, sync_staat, clockSync::stateSize);
+    alles.sync.load(sync_staat);
+
+    scheduler & planner = alles.planner;
+    planner.add(alles.bieper);
+    planner.add(alles.knop_start);
+    planner.add(alles.knop_uitlezen);
+    planner.add(alles.station);
+    planner.add(alles.uit);
+    planner.add(alles.logboek);
+    planner.add(alles.kalibratie);
+#ifdef STATION_TRACE
+    planner.add(alles.spans);
+#endif
+    alles.uit << "Opgestart in " << int((hwlib::now_us() - opstart) / 1000) << " ms" << (snel ? ", lezer was nog ingesteld\n" : "\n");
+    if (lezers.size() != 1){
+        alles.uit << int(lezers.size()) << " kaartlezers\n";
+    }
+    planner.run();
+}
@@ -0,0 +1,39 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "pollSchedule.hpp"
+
+pollSchedule::pollSchedule(readerGroup & readers, const profile & settings):
+    readers( readers ),
+    settings( settings ),
+    lastCard( hwlib::now_us() )
+    {}
+
+uint32_t pollSchedule::wake(){
+    readers.powerUp();
+    asleep = false;
+    return cardPowerUp;     //the field is back on, a card that was in it lost its power too
+}
+
+uint32_t pollSchedule::next(bool card){
+    uint_fast64_t now = hwlib::now_us();
+    if(card){
+        lastCard = now;
+    }
+    if(now - lastCard < uint_fast64_t(settings.activeTime) * 1000){
+        pause = 0;
+        return 0;
+    }
+    pause = pause == 0 ? firstPause : pause * 2;
+    if(pause > settings.idleInterval * 1000){
+        pause = settings.idleInterval * 1000;
+    }
+    if(pause <= cardPowerUp){   //only with an idleInterval shorter than the wake up, awake is cheaper then
+        return pause;
+    }
+    readers.powerDown();
+    asleep = true;
+    return pause;
+}
@@ -0,0 +1,56 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef POLLSCHEDULE_HPP
+#define POLLSCHEDULE_HPP
+
+#include "hwlib.hpp"
+#include "readerGroup.hpp"
+
+/// @file
+
+/// @brief
+/// When to search for a card, and when the readers can sleep
+/// @detail
+/// Right after a card, when more runners are coming, the readers search without a pause. When no card was seen for
+/// activeTime the pauses between searches double up to idleInterval, and during every pause the readers are in their soft
+/// power-down with the field off. A search without a card keeps the field on for the whole timeout of the REQA, so a quiet
+/// post uses a small part of the current it used to. The price is the latency of the first runner after a quiet time: at most
+/// idleInterval plus the wake up of the readers.
+/// The task that searches calls awake() before every search, and returns what wake() and next() return.
+class pollSchedule {
+public:
+    /// @brief Trade-off between the latency of the first runner and the current of the readers.
+    struct profile {
+        uint32_t activeTime;    /// @brief ms after the last card that the readers search without a pause.
+        uint32_t idleInterval;  /// @brief Longest pause between two searches in ms, the longest extra wait of a runner.
+    };
+
+    /// @brief Time in µs after the wake up before a card in the field has the power to answer.
+    const static uint32_t cardPowerUp = 5000;
+    /// @brief First pause in µs after the active time, shorter pauses cost more in waking up than they save.
+    const static uint32_t firstPause = 10000;
+private:
+    readerGroup & readers;
+    profile settings;
+    uint_fast64_t lastCard;
+    uint32_t pause = 0;
+    bool asleep = false;
+public:
+    /// @brief Constructor, the active time starts now.
+    pollSchedule(readerGroup & readers, const profile & settings);
+
+    /// @brief Are the readers awake, so they can search.
+    bool awake() const { return !asleep; }
+
+    /// @brief Wake the readers, returns the µs until a card can answer.
+    uint32_t wake();
+
+    /// @brief After a search, returns the µs until the next one. Puts the readers to sleep for a pause.
+    /// @param card A card was found, so the next runner may be close.
+    uint32_t next(bool card);
+};
+
+#endif //POLLSCHEDULE_HPP
@@ -0,0 +1,160 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "precisionTime.hpp"
+
+#ifdef __SAM3X8E__
+dueTickCounter::dueTickCounter(){
+    PMC->PMC_PCER0 = (1 << ID_TC2);         //turn on the clock of TC0 channel 2
+    PIOA->PIO_PDR = PIO_PA7;                //PA7 (D31) is controlled by the peripheral
+    PIOA->PIO_ABSR |= PIO_PA7;              //peripheral B of PA7 is TCLK2
+    PIOA->PIO_PUER = PIO_PA7;               //SQW/OUT is open drain so it needs a pull-up
+    TC0->TC_BMR = (TC0->TC_BMR & ~TC_BMR_TC2XC2S_Msk) | TC_BMR_TC2XC2S_TCLK2;  //XC2 is TCLK2
+    TC0->TC_CHANNEL[2].TC_CMR = TC_CMR_TCCLKS_XC2;  //count the edges on XC2, no compare or reset
+    TC0->TC_CHANNEL[2].TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+}
+
+uint32_t dueTickCounter::ticks(){
+    return TC0->TC_CHANNEL[2].TC_CV;
+}
+#endif
+
+precisionClock::precisionClock(DS1307 & rtc, tickSource & counter):
+    rtc( rtc ),
+    counter( counter )
+{
+    lastRaw = counter.ticks();
+    extended = (uint64_t(1) << 32) + lastRaw;   //start high so older latched values don't go below zero
+}
+
+uint64_t precisionClock::extend(uint32_t raw){
+    int32_t delta = int32_t(raw - lastRaw);
+    if(delta < 0){      //latched before the last value that was seen
+        return extended - uint32_t(-delta);
+    }
+    lastRaw = raw;
+    extended += uint32_t(delta);
+    return extended;
+}
+
+bool precisionClock::calibrate(uint8_t rounds){
+    startCalibration(rounds);
+    while(calibrating()){
+        hwlib::wait_us(calibrateStep());
+    }
+    return calibrated;
+}
+
+void precisionClock::startCalibration(uint8_t newRounds){
+    calibrated = false;
+    rtc.control(0, 1, 3);   //32.768kHz on SQW/OUT
+    rounds = newRounds;
+    measured = 0;
+    expected = 0;
+    lastChange = extend(counter.ticks());
+    phase = starting;
+}
+
+void precisionClock::rollover(uint32_t second, uint64_t from, uint64_t to){
+    if(measured == 0){
+        firstSecond = second;
+        low = from;
+        high = to;
+    }else{
+        uint64_t shift = uint64_t(second - firstSecond) * counter.rate();  //every rollover is exactly one second of ticks later
+        if(from > low + shift){
+            low = from - shift;
+        }
+        if(to < high + shift){
+            high = to - shift;
+        }
+        if(low > high){     //a second was skipped or the counter missed edges
+            phase = idle;
+            return;
+        }
+    }
+    if(++measured == rounds){
+        alignSeconds = firstSecond;
+        alignTicks = low + (high - low) / 2;
+        errorTicks = (high - low) / 2 + 1;  //half the interval plus one tick of rounding
+        calibrated = true;
+        phase = idle;
+    }
+}
+
+uint32_t precisionClock::calibrateStep(){
+    const uint64_t rate = counter.rate();
+    const uint64_t lead = rate / 25;        //start reading 40 ms before the expected rollover, other tasks may run late
+    const uint64_t sharp = rate / 200;      //a rollover is only measured between reads less than 5 ms apart
+    if(phase == starting){
+        phase = counting;
+        return 2000;    //give the counter 2 ms
+    }
+    if(phase == counting){
+        if(extend(counter.ticks()) == lastChange){      //nothing connected to the counter
+            phase = idle;
+            return 0;
+        }
+        phase = searching;
+        lastStart = extend(counter.ticks());
+        lastSecond = rtc.lezen_tijdstip();
+        lastChange = lastStart;
+        return 0;
+    }
+    if(phase != searching){
+        return 0;
+    }
+
+    //a burst of back to back reads, until the second changes or the rollover should have been seen
+    uint64_t begin = extend(counter.ticks());
+    uint64_t until = expected ? expected + lead : begin + rate / 50;
+    for(;;){
+        uint64_t start = extend(counter.ticks());
+        uint32_t second = rtc.lezen_tijdstip();
+        uint64_t end = extend(counter.ticks());
+        if(second != lastSecond){
+            if(end - lastStart <= sharp){
+                rollover(second, lastStart, end);
+            }
+            expected = lastStart + (end - lastStart) / 2 + rate;
+            if(end - lastStart > rate / 2){     //too rough to know when the next one comes
+                expected = 0;
+            }
+            lastSecond = second;
+            lastStart = start;
+            lastChange = end;
+            if(phase != searching || expected == 0 || end + lead >= expected){
+                return 0;
+            }
+            return microseconds(expected - lead - end);
+        }
+        lastStart = start;
+        if(end - lastChange > 2 * rate){    //no rollover for 2 seconds, the oscilator is off
+            phase = idle;
+            return 0;
+        }
+        if(end > until){
+            if(expected != 0 && end > expected + lead){     //it didn't come when it should have, search again
+                expected = 0;
+            }
+            return 0;
+        }
+    }
+}
+
+preciseTime precisionClock::at(uint32_t latched){
+    const uint32_t rate = counter.rate();
+    if(!calibrated){
+        return {rtc.lezen_tijdstip(), 0, uint16_t(rate - 1)};
+    }
+    int64_t elapsed = int64_t(extend(latched) - alignTicks);
+    int64_t seconds = elapsed / rate;
+    int64_t ticks = elapsed % rate;
+    if(ticks < 0){      //latched before the calibration
+        ticks += rate;
+        seconds--;
+    }
+    return {uint32_t(alignSeconds + seconds), uint16_t(ticks), errorTicks};
+}
@@ -0,0 +1,135 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PRECISIONTIME_HPP
+#define PRECISIONTIME_HPP
+
+#include "hwlib.hpp"
+#include "DS1307.hpp"
+#include "tickSource.hpp"
+
+/// @file
+
+/// @brief
+/// Timestamp with sub-second resolution
+/// @detail
+/// seconds is in the format of DS1307::lezen_tijdstip, ticks is the fraction of the second in 1/32768 s.
+/// The real moment lies within errorTicks ticks of the timestamp.
+struct preciseTime {
+    uint32_t seconds;
+    uint16_t ticks;
+    uint16_t errorTicks;
+
+    /// @brief Fraction of the second in milliseconds.
+    uint16_t milliseconds() const { return (uint32_t(ticks) * 1000) >> 15; }
+};
+
+#ifdef __SAM3X8E__
+/// @brief
+/// Counter for the 32.768 kHz DS1307 output on the Arduino Due
+/// @detail
+/// Counts the SQW/OUT edges in hardware with channel 2 of timer counter TC0, clocked by the external TCLK2 input.
+/// Connect SQW/OUT (with a pull-up) to pin D31 (PA7). Reading the counter is a single register read, so it can be done at any moment.
+class dueTickCounter : public tickSource {
+public:
+    /// @brief Constructor, starts the counter.
+    dueTickCounter();
+
+    uint32_t ticks() override;
+
+    uint32_t rate() const override { return 32768; }
+};
+#endif
+
+/// @brief
+/// Sub-second clock from the DS1307 seconds and the SQW/OUT counter
+/// @detail
+/// The DS1307 only gives whole seconds. Its 32.768 kHz output comes from the same divider chain as the seconds,
+/// so a counter of those edges has a fixed phase relative to the second rollover. calibrate() measures that phase,
+/// after that every counter value can be turned into a timestamp with a fraction of a second without reading the DS1307.
+class precisionClock {
+private:
+    DS1307 & rtc;
+    tickSource & counter;
+    uint32_t alignSeconds = 0;      ///< The second that started at alignTicks.
+    uint64_t alignTicks = 0;        ///< Extended counter value at the start of alignSeconds.
+    uint16_t errorTicks = 0xFFFF;   ///< Half of the uncertainty of alignTicks, plus one tick rounding.
+    uint32_t lastRaw = 0;           ///< Last counter value seen, to extend the counter to 64 bits.
+    uint64_t extended = 0;          ///< 64 bit version of lastRaw.
+    bool calibrated = false;
+
+    const static uint8_t idle       = 0;    ///< Not calibrating.
+    const static uint8_t starting   = 1;    ///< The SQW/OUT output was just turned on.
+    const static uint8_t counting   = 2;    ///< Waiting to see if the counter counts.
+    const static uint8_t searching  = 3;    ///< Reading the DS1307 around the second rollovers.
+    uint8_t phase = idle;
+    uint8_t rounds = 0;             ///< Rollovers still to measure.
+    uint8_t measured = 0;           ///< Rollovers measured.
+    uint32_t lastSecond = 0;        ///< Second of the last DS1307 read.
+    uint64_t lastStart = 0;         ///< Counter at the start of the last read, the rollover was after it.
+    uint64_t lastChange = 0;        ///< Counter when the second changed or the search started.
+    uint64_t expected = 0;          ///< Counter at the next rollover, 0 when not known yet.
+    uint32_t firstSecond = 0;
+    uint64_t low = 0;               ///< Earliest counter value of the first measured rollover.
+    uint64_t high = 0;              ///< Latest counter value of the first measured rollover.
+
+    /// @brief Extend a counter value to 64 bits, works as long as the counter is read once every 18 hours.
+    uint64_t extend(uint32_t raw);
+
+    /// @brief Counter ticks to us.
+    uint32_t microseconds(uint64_t ticks) const { return uint32_t(ticks * 1000000 / counter.rate()); }
+
+    /// @brief A measured rollover between the counter values from and to.
+    void rollover(uint32_t second, uint64_t from, uint64_t to);
+public:
+    /// @brief Constructor
+    /// @param rtc The DS1307 that gives the seconds and the SQW/OUT signal.
+    /// @param counter The counter of the SQW/OUT edges.
+    precisionClock(DS1307 & rtc, tickSource & counter);
+
+    /// @brief Calibrate the clock.
+    /// @detail
+    /// Turns on the 32.768 kHz output with control(0, 1, 3) and watches rounds second rollovers of the DS1307.
+    /// Every rollover narrows down the counter value at which the seconds change. Takes about rounds + 1 seconds.
+    /// Returns false when the counter does not count, then the clock falls back to whole seconds.
+    bool calibrate(uint8_t rounds = 3);
+
+    /// @brief Start calibrating in the background.
+    /// @detail
+    /// The same as calibrate(), but the work is done by calibrateStep(). Until it is done the clock gives whole seconds.
+    void startCalibration(uint8_t rounds = 3);
+
+    /// @brief A piece of the calibration.
+    /// @detail
+    /// The DS1307 is only read around the moment a rollover is expected, in a burst of back to back reads,
+    /// so a rollover is measured as precisely as with calibrate(). Between the bursts other work can be done.
+    /// Returns the us until the next step.
+    uint32_t calibrateStep();
+
+    /// @brief Is a calibration still going on.
+    bool calibrating() const { return phase != idle; }
+
+    /// @brief Is the clock calibrated.
+    bool isCalibrated() const { return calibrated; }
+
+    /// @brief Half of the uncertainty of the calibration in ticks.
+    uint16_t error() const { return errorTicks; }
+
+    /// @brief Latch the counter.
+    /// @detail
+    /// Returns the counter value of this moment, turn it into a timestamp later with at().
+    uint32_t latch() { return counter.ticks(); }
+
+    /// @brief Timestamp of a latched counter value.
+    /// @detail
+    /// Without calibration the DS1307 is read and the fraction is 0 with an error of a whole second.
+    /// @param latched A value returned by latch(), at most 18 hours old.
+    preciseTime at(uint32_t latched);
+
+    /// @brief Timestamp of this moment.
+    preciseTime now() { return at(latch()); }
+};
+
+#endif //PRECISIONTIME_HPP
@@ -0,0 +1,103 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PUNCHCODEC_HPP
+#define PUNCHCODEC_HPP
+
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// Delta and varint coding of punches
+/// @detail
+/// A punch is stored as the station ID followed by the time since the previous punch as a varint:
+/// 7 bits per byte, least significant first, the highest bit is set when another byte follows.
+/// The delta is zigzag coded first, so a punch that is a little earlier than the previous one (after a clock correction) stays small.
+/// Station ID 0 is never used for a punch, a 0 byte means the rest of the block is empty.
+/// Nothing is allocated, everything works on the caller's buffers.
+class punchCodec {
+public:
+    /// @brief Zigzag code a signed delta, 0, -1, 1, -2 becomes 0, 1, 2, 3.
+    static constexpr uint32_t zigzag(int32_t delta){
+        return (uint32_t(delta) << 1) ^ uint32_t(delta >> 31);
+    }
+
+    /// @brief Undo zigzag.
+    static constexpr int32_t unzigzag(uint32_t value){
+        return int32_t(value >> 1) ^ -int32_t(value & 1);
+    }
+
+    /// @brief Bytes needed for a value as varint.
+    static constexpr uint8_t varintSize(uint32_t value){
+        uint8_t size = 1;
+        while(value >= 0x80){
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    /// @brief Bytes needed for one punch with the given delta.
+    static constexpr uint8_t recordSize(int32_t delta){
+        return 1 + varintSize(zigzag(delta));
+    }
+
+    /// @brief Worst case bytes for one punch.
+    /// @detail
+    /// The largest record for a delta that fits in deltaBits signed bits. Use it to check at compile time that a record always fits in a block,
+    /// or to reserve room before the delta is known.
+    /// @param deltaBits Signed bits of the delta, 1 to 32.
+    static constexpr uint8_t worstCaseRecordSize(uint8_t deltaBits = 32){
+        return 1 + varintSize(deltaBits >= 32 ? 0xFFFFFFFF : (uint32_t(1) << deltaBits) - 1);
+    }
+
+    /// @brief Encode one punch.
+    /// @detail
+    /// Writes recordSize(delta) bytes to data and returns that amount.
+    /// @param station Station ID, 1 to 255.
+    /// @param delta Time since the previous punch.
+    /// @param data Buffer of at least recordSize(delta) bytes.
+    static uint8_t encode(uint8_t station, int32_t delta, uint8_t data[]){
+        uint8_t size = 0;
+        data[size++] = station;
+        uint32_t value = zigzag(delta);
+        while(value >= 0x80){
+            data[size++] = (value & 0x7F) | 0x80;
+            value >>= 7;
+        }
+        data[size++] = value;
+        return size;
+    }
+
+    /// @brief Decode one punch.
+    /// @detail
+    /// Returns the amount of bytes used, or 0 when the data is empty (station 0) or the varint does not end within available bytes.
+    /// @param data The bytes to decode.
+    /// @param available Amount of bytes that can be read.
+    /// @param station The decoded station ID.
+    /// @param delta The decoded delta.
+    static uint8_t decode(const uint8_t data[], uint8_t available, uint8_t & station, int32_t & delta){
+        if(available < 2 || data[0] == 0x00){
+            return 0;
+        }
+        uint32_t value = 0;
+        for(uint8_t i = 1; i < available && i < worstCaseRecordSize(); i++){
+            value |= uint32_t(data[i] & 0x7F) << (7 * (i - 1));
+            if((data[i] & 0x80) == 0){
+                station = data[0];
+                delta = unzigzag(value);
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+};
+
+static_assert(punchCodec::worstCaseRecordSize() == 6, "a punch takes at most 6 bytes");
+static_assert(punchCodec::worstCaseRecordSize() <= 16, "a punch has to fit in one block");
+static_assert(punchCodec::recordSize(600) == 3, "a 5 minute delta in seconds takes 3 bytes");
+
+#endif //PUNCHCODEC_HPP
@@ -0,0 +1,389 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "punchLog.hpp"
+
+static uint8_t xorBytes(const uint8_t data[], int length){     //xor of all the bytes
+    uint8_t sum = 0;
+    for(int i = 0; i < length; i++){
+        sum ^= data[i];
+    }
+    return sum;
+}
+
+static void putWord(uint8_t data[], uint32_t word){     //stores a 32 bit word little endian
+    for(int i = 0; i < 4; i++){
+        data[i] = (word >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t getWord(const uint8_t data[]){      //reads a little endian 32 bit word
+    return data[0] | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+static void encodeRecord(const punchRecord & punch, uint32_t start, uint8_t data[8]){
+    uint32_t relative = punch.seconds - start;
+    data[0] = punch.station;
+    data[1] = relative & 0xFF;
+    data[2] = (relative >> 8) & 0xFF;
+    data[3] = (relative >> 16) & 0xFF;
+    data[4] = punch.ticks & 0xFF;
+    data[5] = punch.ticks >> 8;
+    data[6] = 0x00;
+    data[7] = xorBytes(data, 7);
+}
+
+static bool decodeRecord(const uint8_t data[8], uint32_t start, punchRecord & punch){
+    if(data[0] == 0x00 || xorBytes(data, 8) != 0){  //station 0 is an empty record
+        return false;
+    }
+    punch.station = data[0];
+    punch.seconds = start + (data[1] | (uint32_t(data[2]) << 8) | (uint32_t(data[3]) << 16));
+    punch.ticks = data[4] | (uint16_t(data[5]) << 8);
+    return true;
+}
+
+punchLog::punchLog(blockStorage & storage):
+    storage( storage )
+    {}
+
+void punchLog::sealHeader(){    //makes the xor of the header 0
+    header[3] = 0x00;
+    header[3] = xorBytes(header, 16);
+}
+
+uint32_t punchLog::lastUnits() const{
+    return getWord(&header[8]);
+}
+
+uint16_t punchLog::fill() const{
+    return (header[12] | (uint16_t(header[13]) << 8)) & 0x0FFF;
+}
+
+uint8_t punchLog::fractionBits() const{
+    return header[13] >> 4;
+}
+
+bool punchLog::loadBlock(uint8_t block){    //reads a data block into the cache, unless it is already there
+    if(cachedBlock == block){
+        return true;
+    }
+    if(block == endBlock){      //open already read it
+        for(int i = 0; i < 16; i++){
+            cache[i] = endCache[i];
+        }
+    }else if(!storage.readBlock(block, cache)){
+        cachedBlock = 0;
+        return false;
+    }
+    cachedBlock = block;
+    return true;
+}
+
+bool punchLog::isLogHeader(const uint8_t block[16]){
+    return block[0] == logMagic && (block[1] == logVersion || block[1] == deltaVersion) && xorBytes(block, 16) == 0;
+}
+
+uint8_t punchLog::start(uint32_t startTime, uint8_t version, uint8_t fractionBits){
+    if((version != logVersion && version != deltaVersion) || fractionBits > 15){
+        return FormatErr;
+    }
+    for(int i = 0; i < 16; i++){
+        header[i] = 0x00;
+    }
+    header[0] = logMagic;
+    header[1] = version;
+    putWord(&header[4], startTime);
+    if(version == deltaVersion){
+        header[13] = fractionBits << 4;
+    }
+    sealHeader();
+    opened = false;
+    cachedBlock = 0;
+    endBlock = 0;
+    rewind();
+    if(!storage.writeBlock(0, header)){
+        return WriteErr;
+    }
+    opened = true;
+    return OkStatus;
+}
+
+uint8_t punchLog::open(){
+    uint8_t block[16];
+    if(!storage.readBlock(0, block)){
+        return ReadErr;
+    }
+    return open(block);
+}
+
+uint8_t punchLog::open(const uint8_t block[16]){
+    opened = false;
+    cachedBlock = 0;
+    endBlock = 0;
+    rewind();
+    if(!isLogHeader(block)){
+        return FormatErr;
+    }
+    for(int i = 0; i < 16; i++){
+        header[i] = block[i];
+    }
+    uint8_t status = findEnd();
+    if(cachedBlock != 0){   //the stream gets to that block last, by then the cache holds another one
+        for(int i = 0; i < 16; i++){
+            endCache[i] = cache[i];
+        }
+        endBlock = cachedBlock;
+    }
+    opened = status == OkStatus;
+    return status;
+}
+
+void punchLog::setEnd(uint8_t punches, uint32_t units, uint16_t position){
+    header[2] = punches;
+    putWord(&header[8], units);
+    header[12] = position & 0xFF;
+    header[13] = (fractionBits() << 4) | (position >> 8);
+}
+
+uint8_t punchLog::findEnd(){    //counts the punches after the last header write, they are in the block of the last punch it counts
+    if(version() == deltaVersion){
+        return findDeltaEnd();
+    }
+    uint8_t index = count();
+    if(index % recordsPerBlock == 0 || index >= capacity()){    //the header was written with a new block, the next block is not started
+        return OkStatus;
+    }
+    if(!loadBlock(1 + index / recordsPerBlock)){
+        return ReadErr;
+    }
+    punchRecord punch;
+    for(uint8_t slot = index % recordsPerBlock; slot < recordsPerBlock && decodeRecord(&cache[slot * recordSize], startTime(), punch); slot++){
+        header[2]++;
+    }
+    return OkStatus;
+}
+
+uint8_t punchLog::findDeltaEnd(){
+    uint16_t position = fill();
+    if(position % 16 == 0){     //the header was written with a new block, the next block is not started
+        return OkStatus;
+    }
+    if(!loadBlock(1 + position / 16)){
+        return ReadErr;
+    }
+    uint8_t punches = count();
+    uint32_t units = lastUnits();
+    uint8_t offset = position % 16;
+    while(offset < 16 && cache[offset] != 0x00 && punches < 255){   //the rest of a started block is 0 until it is used
+        uint8_t station;
+        int32_t delta;
+        uint8_t size = punchCodec::decode(&cache[offset], 16 - offset, station, delta);
+        if(size == 0){
+            return FormatErr;
+        }
+        offset += size;
+        units += delta;
+        punches++;
+    }
+    setEnd(punches, units, position - position % 16 + offset);
+    return OkStatus;
+}
+
+uint32_t punchLog::startTime() const{
+    return getWord(&header[4]);
+}
+
+uint8_t punchLog::capacity() const{
+    uint16_t records = (storage.blockCount() - 1) * recordsPerBlock;
+    return records > 255 ? 255 : records;
+}
+
+uint16_t punchLog::freeBytes() const{
+    if(version() == logVersion){
+        return (capacity() - count()) * recordSize;
+    }
+    return (storage.blockCount() - 1) * 16 - fill();
+}
+
+uint8_t punchLog::append(const punchRecord & punch){
+    if(!opened){
+        return FormatErr;
+    }
+    if(punch.seconds < startTime()){
+        return RangeErr;
+    }
+    endBlock = 0;   //the kept block may get the new punch
+    if(version() == logVersion){
+        return appendFixed(punch);
+    }
+    return appendDelta(punch);
+}
+
+uint8_t punchLog::appendFixed(const punchRecord & punch){
+    uint8_t index = count();
+    if(index >= capacity()){
+        return FullErr;
+    }
+    if(punch.seconds - startTime() > 0xFFFFFF){
+        return RangeErr;
+    }
+    uint8_t slot = index % recordsPerBlock;
+    uint8_t blockNumber = 1 + index / recordsPerBlock;
+    if(slot == 0){      //a new block, nothing has to be read
+        for(int i = 0; i < 16; i++){
+            cache[i] = 0x00;
+        }
+        cachedBlock = blockNumber;
+    }else if(!loadBlock(blockNumber)){     //open already read it
+        return ReadErr;
+    }
+    encodeRecord(punch, startTime(), &cache[slot * recordSize]);
+    if(!storage.writeBlock(blockNumber, cache)){
+        cachedBlock = 0;
+        return WriteErr;
+    }
+    header[2] = index + 1;
+    if(slot != 0){      //open finds it in the block of the last punch the header counts
+        return OkStatus;
+    }
+    //the data is written first, if the header write fails the punch is simply not counted
+    sealHeader();
+    if(!storage.writeBlock(0, header)){
+        return WriteErr;
+    }
+    return OkStatus;
+}
+
+uint8_t punchLog::appendDelta(const punchRecord & punch){
+    if(count() == 255){
+        return FullErr;
+    }
+    uint8_t bits = fractionBits();
+    uint32_t seconds = punch.seconds - startTime();
+    if(seconds >= (uint64_t(1) << (32 - bits))){    //does not fit in 32 bits of units
+        return RangeErr;
+    }
+    uint32_t units = (seconds << bits) | ((punch.ticks & 0x7FFF) >> (15 - bits));
+    int64_t delta = int64_t(units) - lastUnits();
+    if(delta > INT32_MAX || delta < INT32_MIN){
+        return RangeErr;
+    }
+    uint8_t record[punchCodec::worstCaseRecordSize()];
+    uint8_t size = punchCodec::encode(punch.station, int32_t(delta), record);
+
+    uint16_t position = fill();
+    if(position % 16 + size > 16){  //doesn't fit in the current block, the rest of it stays 0
+        position += 16 - position % 16;
+    }
+    uint8_t blockNumber = 1 + position / 16;
+    if(blockNumber >= storage.blockCount()){
+        return FullErr;
+    }
+    uint8_t offset = position % 16;
+    if(offset == 0){    //a new block, nothing has to be read
+        for(int i = 0; i < 16; i++){
+            cache[i] = 0x00;
+        }
+        cachedBlock = blockNumber;
+    }else if(!loadBlock(blockNumber)){     //open already read it
+        return ReadErr;
+    }
+    for(int i = 0; i < size; i++){
+        cache[offset + i] = record[i];
+    }
+    if(!storage.writeBlock(blockNumber, cache)){
+        cachedBlock = 0;
+        return WriteErr;
+    }
+    setEnd(count() + 1, units, position + size);
+    if(offset != 0){    //open finds it in the block of the last punch the header counts
+        return OkStatus;
+    }
+    //the data is written first, if the header write fails the punch is simply not counted
+    sealHeader();
+    if(!storage.writeBlock(0, header)){
+        return WriteErr;
+    }
+    return OkStatus;
+}
+
+void punchLog::rewind(){
+    streamIndex = 0;
+    streamPosition = 0;
+    streamUnits = 0;
+}
+
+uint8_t punchLog::readNext(punchRecord & punch){
+    if(!opened){
+        return FormatErr;
+    }
+    if(streamIndex >= count()){
+        return RangeErr;
+    }
+    if(version() == logVersion){
+        uint8_t status = readFixed(streamIndex, punch);
+        if(status == OkStatus){
+            streamIndex++;
+        }
+        return status;
+    }
+    while(streamPosition < fill()){
+        uint8_t blockNumber = 1 + streamPosition / 16;
+        uint8_t offset = streamPosition % 16;
+        if(!loadBlock(blockNumber)){
+            return ReadErr;
+        }
+        uint8_t station;
+        int32_t delta;
+        uint8_t size = punchCodec::decode(&cache[offset], 16 - offset, station, delta);
+        if(size == 0){
+            if(cache[offset] != 0x00){  //a record that doesn't end in its block
+                return FormatErr;
+            }
+            streamPosition += 16 - offset;  //the rest of the block is empty
+            continue;
+        }
+        streamPosition += size;
+        streamUnits += delta;
+        streamIndex++;
+        uint8_t bits = fractionBits();
+        punch.station = station;
+        punch.seconds = startTime() + (streamUnits >> bits);
+        punch.ticks = (streamUnits & ((uint32_t(1) << bits) - 1)) << (15 - bits);
+        return OkStatus;
+    }
+    return FormatErr;   //the header counts more punches than there are
+}
+
+uint8_t punchLog::readFixed(uint8_t index, punchRecord & punch){
+    if(!loadBlock(1 + index / recordsPerBlock)){
+        return ReadErr;
+    }
+    if(!decodeRecord(&cache[(index % recordsPerBlock) * recordSize], startTime(), punch)){
+        return FormatErr;
+    }
+    return OkStatus;
+}
+
+uint8_t punchLog::read(uint8_t index, punchRecord & punch){
+    if(!opened){
+        return FormatErr;
+    }
+    if(index >= count()){
+        return RangeErr;
+    }
+    if(version() == logVersion){
+        return readFixed(index, punch);
+    }
+    if(index < streamIndex){
+        rewind();
+    }
+    uint8_t status = OkStatus;
+    while(status == OkStatus && streamIndex <= index){
+        status = readNext(punch);
+    }
+    return status;
+}
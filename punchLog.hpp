@@ -0,0 +1,175 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PUNCHLOG_HPP
+#define PUNCHLOG_HPP
+
+#include <cstdint>
+#include "punchCodec.hpp"
+
+/// @file
+
+/// @brief
+/// Storage made of 16 byte blocks
+/// @detail
+/// Interface between the punch log and the card. Block 0 is the header of the log, the blocks are numbered without gaps.
+class blockStorage {
+public:
+    /// @brief Read one block, returns false when it failed.
+    virtual bool readBlock(uint8_t block, uint8_t data[16]) = 0;
+
+    /// @brief Write one block, returns false when it failed.
+    virtual bool writeBlock(uint8_t block, const uint8_t data[16]) = 0;
+
+    /// @brief Amount of blocks, including the header.
+    virtual uint8_t blockCount() const = 0;
+};
+
+/// @brief
+/// One punch
+/// @detail
+/// seconds is in the format of DS1307::lezen_tijdstip, ticks is the fraction of the second in 1/32768 s.
+struct punchRecord {
+    uint8_t station;
+    uint32_t seconds;
+    uint16_t ticks;
+};
+
+/// @brief
+/// Append-only punch log on a card
+/// @detail
+/// The header (block 0) of both versions starts with:
+/// | byte | content |
+/// |------|---------|
+/// | 0    | magic 'P' |
+/// | 1    | format version |
+/// | 2    | amount of records |
+/// | 3    | checksum, the xor of all 16 header bytes is 0 |
+/// | 4-7  | start time, little endian |
+///
+/// Version 1 has fixed records of 8 bytes: station ID (1 to 255, 0 marks an empty record), 24 bit seconds since the start,
+/// 16 bit ticks, reserved byte and a xor checksum. Every data block holds two records, record n is in block 1 + n/2.
+/// Bytes 8-15 of the header are reserved.
+///
+/// Version 2 stores every punch as station ID and the time since the previous punch, see punchCodec.
+/// Times are counted in units of 2^-fractionBits seconds since the start. A record never crosses a block boundary.
+/// | byte  | content |
+/// |-------|---------|
+/// | 8-11  | time of the last punch in units, little endian |
+/// | 12-13 | bit 0-11: bytes used in the data blocks, bit 12-15: fractionBits |
+/// | 14-15 | reserved |
+///
+/// The header is only written by start() and by a punch that starts a new data block. The punches after the last one it
+/// counts are in the block of that punch, open() reads that block and counts them (and for version 2 adds up their time and size).
+/// A punch in a new block is added by writing the block and the header, a punch in a block that already has data by writing
+/// only that block, with the data from the read of open(). On a card that is one authentication of the sector and one write,
+/// besides the read of the header.
+/// The header can't be left out altogether: start() doesn't erase the blocks, so what is in a block that was not started
+/// again is from an earlier log, and the header is what says which blocks are started. Erasing them costs more writes than it saves.
+class punchLog {
+private:
+    blockStorage & storage;
+    uint8_t header[16];
+    bool opened = false;
+    uint8_t cachedBlock = 0;    ///< Data block in cache, 0 when there is none.
+    uint8_t cache[16];
+    uint8_t endBlock = 0;       ///< Block open() read to find the last punch, kept for readNext, 0 when there is none.
+    uint8_t endCache[16];
+    uint8_t streamIndex = 0;    ///< Next punch readNext returns.
+    uint16_t streamPosition = 0;    ///< Version 2: byte in the data blocks of the next punch.
+    uint32_t streamUnits = 0;   ///< Version 2: time of the previous punch in units.
+
+    void sealHeader();
+    uint32_t lastUnits() const;
+    uint16_t fill() const;
+    uint8_t fractionBits() const;
+    bool loadBlock(uint8_t block);
+    void setEnd(uint8_t punches, uint32_t units, uint16_t position);
+    uint8_t findEnd();
+    uint8_t findDeltaEnd();
+    uint8_t appendFixed(const punchRecord & punch);
+    uint8_t appendDelta(const punchRecord & punch);
+    uint8_t readFixed(uint8_t index, punchRecord & punch);
+public:
+    const static uint8_t logMagic       = 0x50;     /// @brief First byte of the header ('P').
+    const static uint8_t logVersion     = 0x01;     /// @brief Format version with fixed records.
+    const static uint8_t deltaVersion   = 0x02;     /// @brief Format version with delta coded records.
+    const static uint8_t recordSize     = 8;        /// @brief Bytes per record in version 1.
+    const static uint8_t recordsPerBlock = 2;       /// @brief Records per data block in version 1.
+
+    const static uint8_t OkStatus       = 0x00;     /// @brief Everything went Ok.
+    const static uint8_t ReadErr        = 0x01;     /// @brief Reading a block failed.
+    const static uint8_t WriteErr       = 0x02;     /// @brief Writing a block failed.
+    const static uint8_t FormatErr      = 0x03;     /// @brief The header or a record is not valid.
+    const static uint8_t FullErr        = 0x04;     /// @brief No room for another record.
+    const static uint8_t RangeErr       = 0x05;     /// @brief Time before the start or too long after it, or record not in the log.
+
+    /// @brief Constructor
+    /// @param storage The blocks the log is stored in.
+    punchLog(blockStorage & storage);
+
+    /// @brief Check for a log header.
+    /// @param block The block to check.
+    static bool isLogHeader(const uint8_t block[16]);
+
+    /// @brief Start a new log.
+    /// @detail
+    /// Writes an empty header, earlier punches are forgotten.
+    /// @param startTime The start time of the runner.
+    /// @param version logVersion or deltaVersion.
+    /// @param fractionBits Version 2: bits of the ticks that are kept, 0 for whole seconds up to 15 for 1/32768 s.
+    uint8_t start(uint32_t startTime, uint8_t version = deltaVersion, uint8_t fractionBits = 0);
+
+    /// @brief Open the log by reading the header.
+    /// @detail
+    /// Also reads the block of the last punch the header counts, when the punches after it can be in that block.
+    uint8_t open();
+
+    /// @brief Open the log with a header that was already read.
+    /// @detail
+    /// Reads the block of the last punch the header counts, like open().
+    /// @param block Block 0 of the storage.
+    uint8_t open(const uint8_t block[16]);
+
+    /// @brief Format version of the open log.
+    uint8_t version() const { return header[1]; }
+
+    /// @brief Amount of punches in the log.
+    uint8_t count() const { return header[2]; }
+
+    /// @brief Start time of the log.
+    uint32_t startTime() const;
+
+    /// @brief Version 1: maximum amount of punches.
+    uint8_t capacity() const;
+
+    /// @brief Bytes left in the data blocks.
+    uint16_t freeBytes() const;
+
+    /// @brief Add a punch.
+    /// @detail
+    /// Writes the data block of the punch, and the header when the punch starts that block.
+    /// A block that already has data was read by open().
+    /// @param punch The punch to add.
+    uint8_t append(const punchRecord & punch);
+
+    /// @brief Start reading at the first punch.
+    void rewind();
+
+    /// @brief Read the next punch.
+    /// @detail
+    /// Streams the punches in order, every data block is read once. Returns RangeErr after the last punch.
+    /// @param punch The punch that is read.
+    uint8_t readNext(punchRecord & punch);
+
+    /// @brief Read a punch.
+    /// @detail
+    /// Version 1 reads the block of the punch directly, version 2 streams from the start when the punch is before the stream position.
+    /// @param index Number of the punch, starting at 0.
+    /// @param punch The punch that is read.
+    uint8_t read(uint8_t index, punchRecord & punch);
+};
+
+#endif //PUNCHLOG_HPP
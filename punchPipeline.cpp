@@ -0,0 +1,154 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "punchPipeline.hpp"
+#include "stationTrace.hpp"
+
+punchPipeline::punchPipeline(precisionClock & clock, tickSource & counter, clockSync & sync, uint8_t station, uint32_t window,
+                             uint32_t hold):
+    clock( clock ),
+    counter( counter ),
+    sync( sync ),
+    station( station ),
+    recent( window, hold )
+    {}
+
+void punchPipeline::record(uint8_t stage, uint32_t duration){
+    last[stage] = duration;
+    sum[stage] += duration;
+    measured[stage]++;
+    if(duration > worst[stage]){
+        worst[stage] = duration;
+    }
+}
+
+void punchPipeline::endStage(uint8_t stage){     //the time since the previous stage ended
+    uint_fast64_t now = hwlib::now_us();
+    record(stage, now - stageStart);
+    stageStart = now;
+}
+
+void punchPipeline::finishStamp(){
+    if(!stampPending){
+        return;
+    }
+    TRACE_SPAN(encode);
+    uint_fast64_t begin = hwlib::now_us();
+    stamp = clock.at(latched);
+    punch.station = station;
+    punch.seconds = sync.correct(stamp.seconds);
+    punch.ticks = stamp.ticks;
+    stampPending = false;
+    record(timestamp, hwlib::now_us() - begin);
+}
+
+void punchPipeline::whileWaiting(){
+    if(stampPending){
+        stampOverlapped = true;
+        finishStamp();
+    }
+}
+
+uint8_t punchPipeline::run(MFRC522 & rfid, cardStorage & storage, uint8_t UID[5]){
+    uint_fast64_t begin = hwlib::now_us();
+    stageStart = begin;
+    if(!rfid.pollUID(UID, counter, latched)){
+        return NoCard;
+    }
+    endStage(detect);
+    lastReader = 0;
+    return punchCard(rfid, storage, UID, begin);
+}
+
+uint8_t punchPipeline::run(readerGroup & readers, uint8_t UID[5]){
+    uint_fast64_t begin = hwlib::now_us();
+    stageStart = begin;
+    uint8_t found = readers.poll(UID, counter, latched);
+    if(found == readerGroup::none){
+        return NoCard;
+    }
+    endStage(detect);
+    lastReader = found;
+    return punchCard(readers.reader(found), readers.storage(found), UID, begin);
+}
+
+uint8_t punchPipeline::punchCard(MFRC522 & reader, cardStorage & cards, uint8_t UID[5], uint_fast64_t begin){
+    uint32_t now = begin / 1000;
+    if(recent.contains(cardUID(UID), now)){
+        recent.held(cardUID(UID), now);     //a card left on the reader is seen again after every power-down
+        //only a selected card can be halted, one select without retries: a card that misses it is simply seen again
+        if(reader.selectCard(UID) == MFRC522::OkStatus){
+            reader.haltCard();
+        }
+        endStage(close);
+        record(total, hwlib::now_us() - begin);
+        punches++;
+        return AlreadyPunched;
+    }
+    stampPending = true;
+    stampOverlapped = false;
+    reader.setIdleWork(this);     //from here on the timestamp is made while the card answers
+
+    uint8_t result;
+    logStatus = punchLog::OkStatus;
+    if(!cards.open(UID)){
+        result = ReadFailed;
+    }else{
+        endStage(select);
+        if(!cards.readBlock(0, headerBlock)){
+            result = ReadFailed;
+        }else{
+            endStage(header);
+            finishStamp();      //only does something when there was no wait to do it in
+            if(clockSync::isSyncBlock(headerBlock)){
+                result = SyncCard;
+            }else{
+                punchLog log(cards);
+                logStatus = log.open(headerBlock);
+                if(logStatus == punchLog::OkStatus){
+                    logStatus = log.append(punch);
+                }
+                logCount = log.count();
+                logFree = log.freeBytes();
+                endStage(write);
+                result = WriteFailed;
+                if(logStatus == punchLog::OkStatus){
+                    result = Punched;
+                    recent.add(cardUID(UID), now);
+                }
+            }
+        }
+    }
+    finishStamp();
+    cards.close();
+    endStage(close);
+    reader.setIdleWork(nullptr);
+    record(total, hwlib::now_us() - begin);
+    punches++;
+    return result;
+}
+
+const char * punchPipeline::stageName(uint8_t stage){
+    switch(stage){
+        case detect: return "detect";
+        case timestamp: return "timestamp";
+        case select: return "select";
+        case header: return "header";
+        case write: return "write";
+        case close: return "close";
+        case total: return "total";
+        default: return "?";
+    }
+}
+
+void punchPipeline::print(hwlib::ostream & out) const{
+    for(uint8_t stage = 0; stage < stages; stage++){
+        out << stageName(stage) << ": " << int(last[stage]) << " us, gemiddeld " << int(sum[stage] / (measured[stage] ? measured[stage] : 1)) << " us";
+        if(stage == timestamp && stampOverlapped){
+            out << " (tijdens wachten op de kaart)";
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,139 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PUNCHPIPELINE_HPP
+#define PUNCHPIPELINE_HPP
+
+#include "hwlib.hpp"
+#include "MFRC522.hpp"
+#include "cardStorage.hpp"
+#include "precisionTime.hpp"
+#include "clockSync.hpp"
+#include "punchLog.hpp"
+#include "recentCards.hpp"
+#include "readerGroup.hpp"
+
+/// @file
+
+/// @brief
+/// Punch path of a post station with latency measurement
+/// @detail
+/// The counter is latched the moment the UID is received. Turning that into a corrected timestamp (which reads the DS1307 when
+/// the precision clock is not calibrated) and building the punch record is done as idleWork, while the MFRC522 waits for the card
+/// during selection and authentication. Only when the header is read before that work got a chance it is done right away.
+/// A card punched less than the suppression window ago is only selected and halted, without reading or writing it. The window
+/// counts from the punch; a card left on the reader is marked as held every time it is seen, so it is never punched twice.
+/// The duration of every stage is kept in microseconds, so the effect of changes on the punch time can be seen.
+class punchPipeline : public idleWork {
+private:
+    precisionClock & clock;
+    tickSource & counter;
+    clockSync & sync;
+    uint8_t station;
+
+    uint32_t latched = 0;
+    bool stampPending = false;
+    bool stampOverlapped = false;
+    preciseTime stamp = {0, 0, 0};
+    punchRecord punch = {0, 0, 0};
+    uint8_t headerBlock[16] = {0};
+    uint8_t logStatus = punchLog::OkStatus;
+    uint8_t logCount = 0;
+    uint16_t logFree = 0;
+    uint_fast64_t stageStart = 0;
+    uint8_t lastReader = 0;
+    recentCards<64> recent;
+
+    void finishStamp();
+    void record(uint8_t stage, uint32_t duration);
+    void endStage(uint8_t stage);
+    uint8_t punchCard(MFRC522 & reader, cardStorage & cards, uint8_t UID[5], uint_fast64_t begin);
+public:
+    const static uint8_t detect         = 0;    /// @brief REQA and anticollision until the UID is known.
+    const static uint8_t timestamp      = 1;    /// @brief Latched counter to corrected punch time.
+    const static uint8_t select         = 2;    /// @brief Selecting the card.
+    const static uint8_t header         = 3;    /// @brief Authenticating and reading the header block.
+    const static uint8_t write          = 4;    /// @brief Appending the punch, data block and header.
+    const static uint8_t close          = 5;    /// @brief Halting the card.
+    const static uint8_t total          = 6;    /// @brief From the start of the detection to the end.
+    const static uint8_t stages         = 7;
+
+    const static uint8_t NoCard         = 0x00; /// @brief No card in the field.
+    const static uint8_t Punched        = 0x01; /// @brief The punch is on the card.
+    const static uint8_t SyncCard       = 0x02; /// @brief The card is a sync card, see syncBlock().
+    const static uint8_t ReadFailed     = 0x03; /// @brief Selecting, authenticating or reading failed.
+    const static uint8_t WriteFailed    = 0x04; /// @brief The log could not be opened or written, see status().
+    const static uint8_t AlreadyPunched = 0x05; /// @brief The card was punched within the suppression window.
+
+    /// @brief Duration of the last punch per stage in us.
+    uint32_t last[stages] = {0};
+    /// @brief Longest duration per stage in us.
+    uint32_t worst[stages] = {0};
+    /// @brief Sum of the durations per stage in us, divide by measured for the average.
+    uint64_t sum[stages] = {0};
+    /// @brief Amount of durations per stage, a card that was already punched or failed does not reach every stage.
+    uint32_t measured[stages] = {0};
+    /// @brief Amount of cards handled, also the ones that were already punched or failed.
+    uint32_t punches = 0;
+
+    /// @brief Constructor
+    /// @param clock The precision clock.
+    /// @param counter The counter of the precision clock.
+    /// @param sync The clock correction of this station.
+    /// @param station The station ID written with the punch.
+    /// @param window Time in ms in which a card is not punched again.
+    /// @param hold Time in ms in which a card left on the reader is seen again, see recentCards.
+    punchPipeline(precisionClock & clock, tickSource & counter, clockSync & sync, uint8_t station, uint32_t window, uint32_t hold);
+
+    /// @brief Try to punch a card on a single reader.
+    /// @detail
+    /// Returns NoCard at once when there is no card, otherwise runs the whole pipeline and halts the card.
+    /// @param rfid The card reader.
+    /// @param storage The card storage that uses rfid.
+    /// @param UID The UID of the card that was found.
+    uint8_t run(MFRC522 & rfid, cardStorage & storage, uint8_t UID[5]);
+
+    /// @brief Try to punch a card on one of the readers of a group, the cards of all readers share the suppression window.
+    /// @param readers The readers with their card storage.
+    /// @param UID The UID of the card that was found.
+    uint8_t run(readerGroup & readers, uint8_t UID[5]);
+
+    void whileWaiting() override;
+
+    /// @brief Change the suppression window in ms.
+    void setWindow(uint32_t ms){ recent.setWindow(ms); }
+
+    /// @brief Name of a stage.
+    static const char * stageName(uint8_t stage);
+
+    /// @brief Timestamp of the last card, not corrected.
+    const preciseTime & time() const { return stamp; }
+
+    /// @brief The last punch, with the corrected time.
+    const punchRecord & lastPunch() const { return punch; }
+
+    /// @brief The first block of the last card, the sync block for a sync card.
+    const uint8_t * syncBlock() const { return headerBlock; }
+
+    /// @brief The reader of the group the last card was on.
+    uint8_t reader() const { return lastReader; }
+
+    /// @brief punchLog status of the last punch.
+    uint8_t status() const { return logStatus; }
+
+    /// @brief Punches on the last card.
+    uint8_t count() const { return logCount; }
+
+    /// @brief Free bytes on the last card.
+    uint16_t freeBytes() const { return logFree; }
+
+    /// @brief Print the duration of every stage of the last punch and the average.
+    void print(hwlib::ostream & out) const;
+};
+
+//the recent cards are most of the pipeline, the rest is the punch being made and the stage statistics
+static_assert(sizeof(punchPipeline) <= sizeof(recentCards<64>) + 256, "punchPipeline grew beyond its recent cards and statistics");
+
+#endif //PUNCHPIPELINE_HPP
@@ -0,0 +1,116 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "readerGroup.hpp"
+#include "stationTrace.hpp"
+
+bool readerGroup::add(MFRC522 & reader, cardStorage & storage){
+    if(amount >= maxReaders){
+        return false;
+    }
+    readers[amount] = &reader;
+    storages[amount] = &storage;
+    amount++;
+    return true;
+}
+
+void readerGroup::drop(uint8_t i){
+    for(; i + 1 < amount; i++){
+        readers[i] = readers[i + 1];
+        storages[i] = storages[i + 1];
+    }
+    amount--;
+}
+
+static bool answers(MFRC522 & reader){
+    uint8_t version = reader.getVersion();
+    return version == 0x91 || version == 0x92;
+}
+
+bool readerGroup::initialize(){
+    listening = 0;
+    first = 0;
+    //after a restart of the Due the readers that are there may all still be configured
+    uint8_t configured = 0;
+    bool fast = true;
+    for(uint8_t i = 0; i < amount && fast; i++){
+        if(readers[i]->isConfigured()){
+            configured |= 1 << i;
+        }else if(answers(*readers[i])){
+            fast = false;
+        }
+    }
+    if(fast && configured){
+        for(uint8_t i = amount; i-- > 0;){      //backwards, so drop() does not move the readers still to come
+            if(configured & (1 << i)){
+                readers[i]->resume();
+            }else{
+                drop(i);
+            }
+        }
+        return true;
+    }
+    if(amount > 0){
+        readers[0]->hardReset();    //resets them all, a reset per reader would undo the configuration of the readers before it
+    }
+    for(uint8_t i = amount; i-- > 0;){
+        if(answers(*readers[i])){
+            readers[i]->configure();
+        }else{
+            drop(i);
+        }
+    }
+    return false;
+}
+
+uint8_t readerGroup::poll(uint8_t UID[5], tickSource & clock, uint32_t & latched){
+    TRACE_SPAN(detect);
+    if(!listening){
+        for(uint8_t i = 0; i < amount; i++){
+            readers[i]->startRequest();
+        }
+        listening = (1 << amount) - 1;
+        deadline = hwlib::now_us() + answerTime;
+    }
+    for(uint8_t n = 0; n < amount; n++){
+        uint8_t i = (first + n) % amount;
+        if(!(listening & (1 << i))){
+            continue;
+        }
+        uint8_t status = readers[i]->requestStatus();
+        if(status == MFRC522::Busy && hwlib::now_us() <= deadline){
+            continue;
+        }
+        listening &= ~(1 << i);
+        if(status == MFRC522::OkStatus && readers[i]->getUID(UID) == MFRC522::OkStatus){
+            latched = clock.ticks();
+            first = (i + 1) % amount;
+            return i;
+        }
+    }
+    return none;
+}
+
+void readerGroup::cancel(){
+    for(uint8_t i = 0; i < amount; i++){
+        if(listening & (1 << i)){
+            readers[i]->writeRegister(MFRC522::CommandReg, MFRC522::cmdIdle);  //the REQA stops waiting for an answer
+        }
+    }
+    listening = 0;
+}
+
+void readerGroup::powerDown(){
+    listening = 0;      //a card that answered loses its power too
+    for(uint8_t i = 0; i < amount; i++){
+        readers[i]->powerDown();
+    }
+}
+
+void readerGroup::powerUp(){
+    for(uint8_t i = 0; i < amount; i++){
+        readers[i]->powerUp();
+    }
+}
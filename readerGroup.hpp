@@ -0,0 +1,79 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef READERGROUP_HPP
+#define READERGROUP_HPP
+
+#include "MFRC522.hpp"
+#include "cardStorage.hpp"
+#include "tickSource.hpp"
+
+/// @file
+
+/// @brief
+/// Card readers side by side on one SPI bus
+/// @detail
+/// Every MFRC522 has its own select pin on the shared spiSetup, the reset pin is shared. A search sends a REQA on every reader,
+/// so all readers wait for their cards at the same time and a search takes the timeout of one REQA, however many readers
+/// there are. poll() does not wait for the answers: it looks at every reader once and returns, the other tasks run while the
+/// cards answer. The first reader with a card is handled; a reader that found a card too keeps the answer, the next poll()
+/// starts looking after the reader that was handled last, so with a card on every reader each one gets its turn.
+/// The exchanges with the cards share the bus, so they are done one after the other.
+class readerGroup {
+public:
+    const static uint8_t maxReaders = 4;
+    const static uint8_t none = 0xFF;       /// @brief No reader found a card.
+    /// @brief µs the cards get to answer the REQA. The ATQA is there within half a ms, the 25 ms timeout of
+    /// MFRC522::communicate() would only make a card that is put on the reader just after a REQA wait for the next one.
+    const static uint32_t answerTime = 1000;
+private:
+    MFRC522 * readers[maxReaders];
+    cardStorage * storages[maxReaders];
+    uint8_t amount = 0;
+    uint8_t listening = 0;  //a bit for every reader with a REQA that was not handled yet
+    uint8_t first = 0;      //the reader that is looked at first by the next poll
+    uint_fast64_t deadline = 0;
+
+    void drop(uint8_t i);
+public:
+    /// @brief Add a reader with the card storage that uses it, returns false when there are already maxReaders readers.
+    bool add(MFRC522 & reader, cardStorage & storage);
+
+    /// @brief Start the readers, readers that don't answer are left out.
+    /// @detail
+    /// Like MFRC522::fastInitialize(): returns true when the readers were still configured and the reset was skipped.
+    bool initialize();
+
+    /// @brief The amount of readers.
+    uint8_t size() const { return amount; }
+
+    MFRC522 & reader(uint8_t i) const { return *readers[i]; }
+
+    cardStorage & storage(uint8_t i) const { return *storages[i]; }
+
+    /// @brief Look once at the search of all readers, starts a new search when the last one is done.
+    /// @detail
+    /// Returns the reader that found a card, or none when no card answered yet or the search is done without a card.
+    /// @param UID The UID of the card.
+    /// @param clock Latched the moment the UID is received.
+    uint8_t poll(uint8_t UID[5], tickSource & clock, uint32_t & latched);
+
+    /// @brief Are readers still waiting for their cards, the search is not done yet.
+    bool searching() const { return listening != 0; }
+
+    /// @brief Stop the search, for a station that is no longer a post.
+    void cancel();
+
+    /// @brief Soft power-down of every reader, see pollSchedule.
+    void powerDown();
+
+    /// @brief Wake every reader.
+    void powerUp();
+};
+
+//the readers and their storage belong to main, the group only points at them
+static_assert(sizeof(readerGroup) <= 2 * readerGroup::maxReaders * sizeof(void *) + 16, "readerGroup may not own its readers");
+
+#endif //READERGROUP_HPP
@@ -0,0 +1,183 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "readoutFrame.hpp"
+#include <cstring>
+
+uint16_t readoutFrame::crc16(uint16_t crc, uint8_t byte){   //polynomial 0x1021, most significant bit first
+    crc ^= uint16_t(byte) << 8;
+    for(uint8_t i = 0; i < 8; i++){
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+frameWriter::frameWriter(byteSink & sink):
+    sink( sink )
+    {}
+
+void frameWriter::addRaw(uint8_t byte){
+    crc = readoutFrame::crc16(crc, byte);
+    sink.put(byte);
+}
+
+void frameWriter::begin(uint8_t type, const cardUID & uid, uint16_t payloadLength){
+    uint16_t length = 1 + 4 + payloadLength;
+    sink.put(readoutFrame::startByte);  //not in the CRC
+    crc = 0xFFFF;
+    addRaw(length & 0xFF);
+    addRaw(length >> 8);
+    addRaw(type);
+    for(uint8_t i = 0; i < 4; i++){
+        addRaw(uid[i]);
+    }
+}
+
+void frameWriter::add(uint8_t byte){
+    addRaw(byte);
+}
+
+void frameWriter::add16(uint16_t value){
+    addRaw(value & 0xFF);
+    addRaw(value >> 8);
+}
+
+void frameWriter::add32(uint32_t value){
+    add16(value & 0xFFFF);
+    add16(value >> 16);
+}
+
+void frameWriter::addPunch(const punchRecord & punch){
+    add(punch.station);
+    add32(punch.seconds);
+    add16(punch.ticks);
+}
+
+void frameWriter::end(){
+    uint16_t result = crc;
+    sink.put(result & 0xFF);
+    sink.put(result >> 8);
+}
+
+bool frameParser::feed(uint8_t byte){
+    if(found){      //the frame of the last true makes room, a frame is never smaller than the byte that comes in
+        next();
+    }
+    buffer[filled++] = byte;
+    return next();
+}
+
+bool frameParser::next(){
+    if(found){      //forget the frame that was returned, the bytes after it are still to be looked at
+        filled -= used;
+        std::memmove(buffer, buffer + used, filled);
+        used = 0;
+        found = false;
+    }
+    while(used < filled){
+        if(step()){
+            found = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool frameParser::end(){
+    if(next()){
+        return true;
+    }
+    while(current != state::start){     //cut off, not counted as a bad frame
+        current = state::start;
+        used = 0;
+        if(next()){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool frameParser::step(){
+    if(current == state::start){    //only the start byte and what follows it is kept
+        uint16_t first = 0;
+        while(first < filled && buffer[first] != readoutFrame::startByte){
+            first++;
+        }
+        skipped += first;
+        if(first == filled){
+            filled = 0;
+            return false;
+        }
+        filled -= first + 1;
+        std::memmove(buffer, buffer + first + 1, filled);
+        current = state::length;
+        crc = 0xFFFF;
+        return false;
+    }
+    uint8_t byte = buffer[used++];
+    bool wrong = false;
+    switch(current){
+        case state::length:
+            crc = readoutFrame::crc16(crc, byte);
+            if(used == 2){
+                length = buffer[0] | (uint16_t(buffer[1]) << 8);
+                wrong = length < 5 || length > readoutFrame::maxLength;
+                current = state::body;
+            }
+            break;
+        case state::body:
+            crc = readoutFrame::crc16(crc, byte);
+            if(used == 2 + length){
+                current = state::crc;
+            }
+            break;
+        case state::crc:
+            if(used == 2 + length + 2){
+                if((buffer[used - 2] | (uint16_t(buffer[used - 1]) << 8)) == crc){
+                    current = state::start;
+                    return true;
+                }
+                wrong = true;
+            }
+            break;
+        default:
+            break;
+    }
+    if(wrong){      //the start byte was not the start of a frame, look again from the byte after it
+        badFrames++;
+        current = state::start;
+        used = 0;
+    }
+    return false;
+}
+
+static uint32_t read32(const uint8_t * data){
+    return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+bool frameParser::readoutHeader(uint32_t & start, uint8_t & version, uint8_t & count) const{
+    if(type() != readoutFrame::readoutType || payloadLength() < readoutFrame::readoutHeaderSize){
+        return false;
+    }
+    start = read32(payload());
+    version = payload()[4];
+    count = payload()[5];
+    return payloadLength() == readoutFrame::readoutHeaderSize + count * readoutFrame::punchSize;
+}
+
+punchRecord frameParser::punch(uint8_t i) const{
+    const uint8_t * data = payload() + readoutFrame::readoutHeaderSize + i * readoutFrame::punchSize;
+    return {data[0], read32(&data[1]), uint16_t(data[5] | (data[6] << 8))};
+}
+
+bool frameParser::journalPunch(punchRecord & punch, uint8_t & status) const{
+    if(type() != readoutFrame::punchType || payloadLength() != readoutFrame::punchFrameSize){
+        return false;
+    }
+    const uint8_t * data = payload();
+    punch = {data[0], read32(&data[1]), uint16_t(data[5] | (data[6] << 8))};
+    status = data[7];
+    return true;
+}
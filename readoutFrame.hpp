@@ -0,0 +1,157 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef READOUTFRAME_HPP
+#define READOUTFRAME_HPP
+
+#include <cstdint>
+#include "punchLog.hpp"
+#include "cardUID.hpp"
+
+/// @file
+
+/// @brief
+/// Destination of the bytes of a frame
+class byteSink {
+public:
+    /// @brief Add one byte.
+    virtual void put(uint8_t byte) = 0;
+};
+
+/// @brief
+/// Binary frames of the base station
+/// @detail
+/// Every frame is:
+/// | bytes  | content |
+/// |--------|---------|
+/// | 1      | start byte 0xA5 |
+/// | 2      | length of type, UID and payload, little endian |
+/// | 1      | type |
+/// | 4      | UID of the card |
+/// | length - 5 | payload |
+/// | 2      | CRC-16/CCITT-FALSE of the length, type, UID and payload, little endian |
+///
+/// The payload of a readout is start time (4 bytes), log version, amount of punches and then 7 bytes per punch:
+/// station, seconds (4 bytes) and ticks (2 bytes). A start frame has the start time as payload, an error frame the status.
+/// A post sends a punch frame for every card it punched: the punch in the same 7 bytes and the punchLog status, so the
+/// captured serial output of a post is its journal.
+/// A log frame carries one message of stationLog with UID 0, see stationLog for its payload.
+/// A trace frame (UID 0) has the rate of the trace clock (4 bytes) and then events of stationTrace, 5 bytes each: ID and time.
+/// All numbers are little endian. Text never contains 0xA5, so a receiver can find the next frame after any text or garbage.
+class readoutFrame {
+public:
+    const static uint8_t startByte      = 0xA5;
+    const static uint8_t readoutType    = 0x01; /// @brief Readout of a card.
+    const static uint8_t startType      = 0x02; /// @brief A card was started.
+    const static uint8_t errorType      = 0x03; /// @brief A card could not be read, payload is the status.
+    const static uint8_t punchType      = 0x04; /// @brief A post punched a card, payload is the punch and the status.
+    const static uint8_t logType        = 0x05; /// @brief A message of the drivers, payload is a stationLog message.
+    const static uint8_t traceType      = 0x06; /// @brief Span events of stationTrace, payload is the clock rate and the events.
+
+    const static uint8_t readoutHeaderSize = 6;
+    const static uint8_t punchSize = 7;
+    const static uint8_t punchFrameSize = punchSize + 1;
+    /// @brief Largest length field, a readout of 255 punches.
+    const static uint16_t maxLength = 1 + 4 + readoutHeaderSize + 255 * punchSize;
+
+    /// @brief Bytes of a whole frame with a payload of payloadLength bytes.
+    static constexpr uint16_t frameSize(uint16_t payloadLength){ return 1 + 2 + 1 + 4 + payloadLength + 2; }
+
+    /// @brief Bytes of the frame of a readout with count punches.
+    static constexpr uint16_t readoutSize(uint8_t count){ return frameSize(readoutHeaderSize + count * punchSize); }
+
+    /// @brief Add one byte to a CRC-16/CCITT-FALSE, start with 0xFFFF.
+    static uint16_t crc16(uint16_t crc, uint8_t byte);
+};
+
+/// @brief
+/// Writes frames byte by byte
+/// @detail
+/// The length is given at the start, so the punches can be written while they are read from the card.
+class frameWriter {
+private:
+    byteSink & sink;
+    uint16_t crc = 0xFFFF;
+
+    void addRaw(uint8_t byte);
+public:
+    frameWriter(byteSink & sink);
+
+    /// @brief Start a frame.
+    /// @param type Type of the frame.
+    /// @param uid The card.
+    /// @param payloadLength The amount of bytes that will be added.
+    void begin(uint8_t type, const cardUID & uid, uint16_t payloadLength);
+
+    void add(uint8_t byte);
+
+    void add16(uint16_t value);
+
+    void add32(uint32_t value);
+
+    /// @brief Add a punch of a readout.
+    void addPunch(const punchRecord & punch);
+
+    /// @brief Add the CRC, the frame is complete.
+    void end();
+};
+
+/// @brief
+/// Finds and checks frames in a stream of bytes
+/// @detail
+/// Bytes outside a frame are skipped, a frame with a wrong length or CRC is counted and skipped. A 0xA5 in a UID or a
+/// payload, or a frame that lost bytes, also looks like the start of a frame and takes the bytes after it. When that frame
+/// turns out wrong, the bytes after its start byte are looked at again, so the frames in them are still found. feed()
+/// returns the first of those frames, next() the others. Meant for the host, it keeps a buffer of the largest frame.
+class frameParser {
+private:
+    enum class state { start, length, body, crc };
+    const static uint16_t bufferSize = 2 + readoutFrame::maxLength + 2 + 1;
+    state current = state::start;
+    uint8_t buffer[bufferSize];     //the frame that is read from its length on, then the bytes that are not looked at yet
+    uint16_t used = 0;              //bytes of the frame that is read
+    uint16_t filled = 0;            //bytes in the buffer
+    bool found = false;             //the buffer starts with the frame of the last true
+    uint16_t length = 0;
+    uint16_t crc = 0;
+
+    /// @brief Look at the byte after the frame that is read, returns true when it completes a good frame.
+    bool step();
+public:
+    /// @brief Frames with a wrong CRC or length.
+    uint32_t badFrames = 0;
+    /// @brief Bytes that were not part of a frame.
+    uint32_t skipped = 0;
+
+    /// @brief Give the next byte, returns true when it completed a good frame.
+    bool feed(uint8_t byte);
+
+    /// @brief The next frame of bytes that were looked at again, call it until it returns false after feed() returned true.
+    bool next();
+
+    /// @brief The stream ended, call it until it returns false.
+    /// @detail
+    /// A frame that is not complete yet never will be, the frames in the bytes after its start byte are returned.
+    bool end();
+
+    uint8_t type() const { return buffer[2]; }
+
+    cardUID uid() const { return cardUID(&buffer[3]); }
+
+    const uint8_t * payload() const { return &buffer[7]; }
+
+    uint16_t payloadLength() const { return length - 5; }
+
+    /// @brief Read the start of a readout, returns false when this is not a good readout frame.
+    bool readoutHeader(uint32_t & start, uint8_t & version, uint8_t & count) const;
+
+    /// @brief Punch i of a readout.
+    punchRecord punch(uint8_t i) const;
+
+    /// @brief Read a punch frame, returns false when this is not a good punch frame.
+    bool journalPunch(punchRecord & punch, uint8_t & status) const;
+};
+
+#endif //READOUTFRAME_HPP
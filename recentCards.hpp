@@ -0,0 +1,116 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RECENTCARDS_HPP
+#define RECENTCARDS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "cardUID.hpp"
+
+/// @file
+
+/// @brief
+/// Cards punched in the last window milliseconds
+/// @detail
+/// A fixed size open addressed table of N places (a power of two) without dynamic memory. A UID is looked up in at most
+/// probes places starting at its hash, so both find and add take constant time. When all those places are taken by cards
+/// that are still suppressed the oldest is overwritten, a full table only makes the window shorter for some cards.
+/// The window counts from the punch, seeing the card again does not move it. A card left on the reader is seen again
+/// after every sleep of the reader and is marked as held; it stays suppressed while it is seen again within hold ms.
+/// Times are in milliseconds and may wrap around.
+template< size_t N, size_t probes = 4 >
+class recentCards {
+    static_assert((N & (N - 1)) == 0 && N >= probes, "N must be a power of two and at least probes");
+private:
+    struct entry {
+        cardUID uid;
+        bool used;
+        uint32_t time;  //the punch
+        uint32_t held;  //the last time the card was seen, the punch until it is seen again
+    };
+    entry table[N] = {};
+    uint32_t window;
+    uint32_t hold;
+
+    bool inWindow(const entry & e, uint32_t now) const {
+        return e.used && ((now - e.time) < window || (now - e.held) < hold);
+    }
+
+    size_t find(const cardUID & uid) const {    //the place of the card, N when it is not there
+        size_t start = uid.hash();
+        for(size_t i = 0; i < probes; i++){
+            const entry & e = table[(start + i) & (N - 1)];
+            if(e.used && e.uid == uid){
+                return (start + i) & (N - 1);
+            }
+        }
+        return N;
+    }
+public:
+    /// @brief Constructor
+    /// @param window Time in ms in which a card is not punched again.
+    /// @param hold Time in ms in which a card left on the reader is seen again.
+    recentCards(uint32_t window, uint32_t hold):
+        window( window ),
+        hold( hold )
+        {}
+
+    /// @brief Change the window, cards already in the table use the new window.
+    void setWindow(uint32_t ms){ window = ms; }
+
+    /// @brief The window in ms.
+    uint32_t getWindow() const { return window; }
+
+    /// @brief Is this card suppressed: added less than window ms before now, or held and seen less than hold ms ago.
+    bool contains(const cardUID & uid, uint32_t now) const {
+        size_t place = find(uid);
+        return place != N && inWindow(table[place], now);
+    }
+
+    /// @brief A suppressed card is seen again at time now, its punch keeps its window.
+    void held(const cardUID & uid, uint32_t now){
+        size_t place = find(uid);
+        if(place != N){
+            table[place].held = now;
+        }
+    }
+
+    /// @brief Add a card punched at time now, a card that is already there starts a new window.
+    void add(const cardUID & uid, uint32_t now){
+        size_t start = uid.hash();
+        entry * place = nullptr;
+        for(size_t i = 0; i < probes; i++){
+            entry & e = table[(start + i) & (N - 1)];
+            if(e.used && e.uid == uid){
+                place = &e;
+                break;
+            }
+            if(place == nullptr || (!inWindow(e, now) && inWindow(*place, now)) ||
+               (inWindow(e, now) == inWindow(*place, now) && (now - e.held) > (now - place->held))){
+                place = &e;     //a free or expired place, otherwise the card seen longest ago
+            }
+        }
+        place->uid = uid;
+        place->used = true;
+        place->time = now;
+        place->held = now;
+    }
+
+    /// @brief Forget all cards.
+    void clear(){
+        for(size_t i = 0; i < N; i++){
+            table[i].used = false;
+        }
+    }
+
+    /// @brief Amount of places in the table.
+    static constexpr size_t capacity(){ return N; }
+};
+
+//a place is a UID and two times, the table of the pipeline has 64 places
+static_assert(sizeof(recentCards<64>) <= 64 * 16 + 2 * sizeof(uint32_t), "a place of recentCards may only hold a UID and two times");
+
+#endif //RECENTCARDS_HPP
@@ -0,0 +1,97 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef REGISTERFIELD_HPP
+#define REGISTERFIELD_HPP
+
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// A register of a chip
+/// @detail
+/// The address, the value after a reset, and the bits that keep what is written to them. The other bits are read-only,
+/// or act on the write only, like a flush bit or the interrupt bits that are only changed where a 1 is written; a write
+/// puts a 0 in them, which does nothing. A write that sets only some fields has to repeat the stored bits of the other
+/// fields, so it reads the register first, see fieldUpdate::whole().
+template< uint8_t Address, uint8_t ResetValue = 0x00, uint8_t Stored = 0xFF >
+struct chipRegister {
+    const static uint8_t address = Address;
+    const static uint8_t resetValue = ResetValue;
+    const static uint8_t stored = Stored;
+};
+
+/// @brief
+/// New values for some fields of register Reg
+/// @detail
+/// Updates of the same register are combined with |, at compile time when they are constants, so a driver sets several
+/// fields with one write. Updates of different registers don't combine, that fails to compile.
+template< typename Reg >
+struct fieldUpdate {
+    uint8_t mask;
+    uint8_t value;
+
+    /// @brief The value of the register after the update, from the value it had.
+    constexpr uint8_t applyTo(uint8_t old) const { return uint8_t((old & ~mask) | value); }
+
+    /// @brief Does the update decide every stored bit, so it is written without reading the register first.
+    constexpr bool whole() const { return (Reg::stored & ~mask) == 0; }
+};
+
+/// @brief Both updates in one, where they overlap the right one wins.
+template< typename Reg >
+constexpr fieldUpdate< Reg > operator|(fieldUpdate< Reg > left, fieldUpdate< Reg > right){
+    return {uint8_t(left.mask | right.mask), uint8_t((left.value & ~right.mask) | right.value)};
+}
+
+/// @brief
+/// A field of Width bits from bit Shift on in register Reg
+/// @detail
+/// to() makes the update that writes the field. A value that does not fit, and writing a read-only field, fail to compile;
+/// a value only known at run time is cut off to the width of the field.
+template< typename Reg, uint8_t Shift, uint8_t Width = 1, bool ReadOnly = false >
+struct registerField {
+    static_assert(Width > 0 && Shift + Width <= 8, "a field lies within its register");
+
+    using inRegister = Reg;
+    const static uint8_t mask = uint8_t(((1 << Width) - 1) << Shift);
+
+    template< uint8_t Value >
+    static constexpr fieldUpdate< Reg > to(){
+        static_assert(!ReadOnly, "this field is read-only");
+        static_assert(Value < (1 << Width), "the value does not fit in the field");
+        return {mask, uint8_t(Value << Shift)};
+    }
+
+    static constexpr fieldUpdate< Reg > to(uint8_t value){
+        static_assert(!ReadOnly, "this field is read-only");
+        return {mask, uint8_t((value << Shift) & mask)};
+    }
+
+    /// @brief The field out of a value of the register.
+    static constexpr uint8_t from(uint8_t registerValue){ return uint8_t((registerValue & mask) >> Shift); }
+};
+
+/// @brief A read-only field, it can be read but not written.
+template< typename Reg, uint8_t Shift, uint8_t Width = 1 >
+using readOnlyField = registerField< Reg, Shift, Width, true >;
+
+/// @brief
+/// The whole value of a register after a reset and an update, for tables of registers that are written at once
+/// @detail
+/// The stored bits are there for a check of the table against the chip, the other bits read back as the chip likes.
+struct registerValue {
+    uint8_t address;
+    uint8_t value;
+    uint8_t stored;
+};
+
+template< typename Reg >
+constexpr registerValue afterReset(fieldUpdate< Reg > update){
+    return {Reg::address, update.applyTo(Reg::resetValue), Reg::stored};
+}
+
+#endif //REGISTERFIELD_HPP
@@ -0,0 +1,67 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "retryPolicy.hpp"
+#include "MFRC522.hpp"
+#include "stationLog.hpp"
+
+//one recovery per attempt, a broken answer is asked again first, a card that keeps quiet is selected again first
+static constexpr uint8_t plan[retryPolicy::classes][retryPolicy::maxAttempts] = {
+    {retryPolicy::abort,     retryPolicy::abort,     retryPolicy::abort},        //none
+    {retryPolicy::retryNow,  retryPolicy::reselect,  retryPolicy::abort},        //collision
+    {retryPolicy::retryNow,  retryPolicy::reselect,  retryPolicy::resetField},   //corrupted
+    {retryPolicy::reselect,  retryPolicy::resetField, retryPolicy::abort},       //timeOut
+    {retryPolicy::retryNow,  retryPolicy::reselect,  retryPolicy::abort},        //overflow
+    {retryPolicy::reselect,  retryPolicy::abort,     retryPolicy::abort},        //refused, a NAK puts the card back in IDLE
+    {retryPolicy::abort,     retryPolicy::abort,     retryPolicy::abort},        //gone
+    {retryPolicy::abort,     retryPolicy::abort,     retryPolicy::abort}         //fatal
+};
+
+uint8_t retryPolicy::classify(uint8_t status){
+    switch(status){
+        case MFRC522::OkStatus: return none;
+        case MFRC522::CollErr: return collision;
+        case MFRC522::CRCErr:
+        case MFRC522::ParityErr:
+        case MFRC522::ProtocolErr:
+        case MFRC522::BCCErr: return corrupted;
+        case MFRC522::TimeOut: return timeOut;
+        case MFRC522::BufferOvrlErr: return overflow;
+        case MFRC522::Statuserr: return refused;
+        default: return fatal;
+    }
+}
+
+uint8_t retryPolicy::next(uint8_t failure, uint8_t attempt){
+    uint8_t recovery = failure < classes && attempt < maxAttempts ? plan[failure][attempt] : abort;
+    failures[failure < classes ? failure : fatal]++;
+    done[recovery]++;
+    return recovery;
+}
+
+void retryPolicy::finish(uint8_t failure, uint8_t attempts){
+    exchanges++;
+    if(failure != none){
+        failed++;
+        LOG_WARN(stationLog::exchangeFailed, failure, attempts);
+    }else if(attempts > 0){
+        saved++;
+        LOG_INFO(stationLog::exchangeSaved, attempts);
+    }
+}
+
+const char * retryPolicy::className(uint8_t failure){
+    switch(failure){
+        case none: return "none";
+        case collision: return "collision";
+        case corrupted: return "corrupted";
+        case timeOut: return "time out";
+        case overflow: return "overflow";
+        case refused: return "NAK";
+        case gone: return "gone";
+        case fatal: return "fatal";
+        default: return "?";
+    }
+}
@@ -0,0 +1,70 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RETRYPOLICY_HPP
+#define RETRYPOLICY_HPP
+
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// What to do when a card exchange fails
+/// @detail
+/// A failed exchange is put in a class by its MFRC522 status. Every class has its own recoveries, one per attempt:
+/// a card that answered with a broken frame is still in its state and can be asked again right away, a card that did not
+/// answer has lost its state and has to be selected again, and when that does not help the field is switched off and on.
+/// A card that does not answer a WUPA anymore has left the field and is given up at once.
+/// An exchange gets at most maxAttempts recoveries, so a card that really is gone costs a bounded time.
+/// The policy keeps statistics of how often each class happens and how often a retry saved the exchange.
+class retryPolicy {
+public:
+    const static uint8_t none       = 0;    ///< The exchange went well.
+    const static uint8_t collision  = 1;    ///< Two cards answered at the same time.
+    const static uint8_t corrupted  = 2;    ///< CRC, parity, protocol or BCC error, the answer was broken.
+    const static uint8_t timeOut    = 3;    ///< The card did not answer.
+    const static uint8_t overflow   = 4;    ///< The answer did not fit.
+    const static uint8_t refused    = 5;    ///< The card answered with a NAK.
+    const static uint8_t gone       = 6;    ///< The card does not answer a WUPA, or another card answered.
+    const static uint8_t fatal      = 7;    ///< Temperature or write error of the MFRC522, retrying won't help.
+    const static uint8_t classes    = 8;
+
+    const static uint8_t abort      = 0;    ///< Give up.
+    const static uint8_t retryNow   = 1;    ///< Do the exchange again.
+    const static uint8_t reselect   = 2;    ///< Halt, WUPA and select the card again, then do the exchange again.
+    const static uint8_t resetField = 3;    ///< Switch the field off and on, then reselect.
+    const static uint8_t recoveries = 4;
+
+    const static uint8_t maxAttempts = 3;   ///< Recoveries of one exchange at most.
+
+    /// @brief Exchanges finished.
+    uint32_t exchanges = 0;
+    /// @brief Exchanges that went well after one or more recoveries.
+    uint32_t saved = 0;
+    /// @brief Exchanges given up.
+    uint32_t failed = 0;
+    /// @brief Failures per class.
+    uint16_t failures[classes] = {0};
+    /// @brief Recoveries done per kind, abort included.
+    uint16_t done[recoveries] = {0};
+
+    /// @brief Class of an MFRC522 status.
+    static uint8_t classify(uint8_t status);
+
+    /// @brief The recovery of a failure, counts both.
+    /// @param failure Class of the failure.
+    /// @param attempt Recoveries done already in this exchange.
+    uint8_t next(uint8_t failure, uint8_t attempt);
+
+    /// @brief Count the end of an exchange.
+    /// @param failure Class of the last failure, none when the exchange went well.
+    /// @param attempts Recoveries done in the exchange.
+    void finish(uint8_t failure, uint8_t attempts);
+
+    /// @brief Name of a failure class.
+    static const char * className(uint8_t failure);
+};
+
+#endif //RETRYPOLICY_HPP
@@ -0,0 +1,64 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <cstddef>
+
+/// @file
+
+/// @brief
+/// Fixed size FIFO
+/// @detail
+/// A first in first out buffer of N elements without dynamic memory. push fails when the buffer is full, nothing is overwritten.
+template< typename T, size_t N >
+class ringBuffer {
+private:
+    T data[N];
+    size_t head = 0;    ///< Position of the oldest element.
+    size_t amount = 0;  ///< Elements in the buffer.
+public:
+    /// @brief Add an element, returns false when the buffer is full.
+    bool push(const T & value){
+        if(amount == N){
+            return false;
+        }
+        data[(head + amount) % N] = value;
+        amount++;
+        return true;
+    }
+
+    /// @brief Take the oldest element, returns false when the buffer is empty.
+    bool pop(T & value){
+        if(amount == 0){
+            return false;
+        }
+        value = data[head];
+        head = (head + 1) % N;
+        amount--;
+        return true;
+    }
+
+    /// @brief The oldest element, only valid when the buffer is not empty.
+    const T & front() const { return data[head]; }
+
+    /// @brief Remove all elements.
+    void clear(){ head = 0; amount = 0; }
+
+    /// @brief Is the buffer empty.
+    bool empty() const { return amount == 0; }
+
+    /// @brief Elements in the buffer.
+    size_t size() const { return amount; }
+
+    /// @brief Free places in the buffer.
+    size_t space() const { return N - amount; }
+
+    /// @brief Maximum amount of elements.
+    static constexpr size_t capacity(){ return N; }
+};
+
+#endif //RINGBUFFER_HPP
@@ -0,0 +1,128 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RUNNERREGISTRY_HPP
+#define RUNNERREGISTRY_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "cardUID.hpp"
+
+/// @file
+
+/// @brief
+/// A card and the runner it belongs to
+struct runner {
+    cardUID uid;
+    uint16_t number;        ///< Start number.
+    const char * name;
+    const char * category;
+};
+
+/// @brief Smallest power of two that is at least n.
+constexpr size_t powerOfTwo(size_t n){
+    size_t p = 1;
+    while(p < n){
+        p <<= 1;
+    }
+    return p;
+}
+
+/// @brief
+/// Registry of runners made at compile time with a perfect hash
+/// @detail
+/// The runners are split in buckets of about 4 by uid.hash(0). For every bucket, biggest first, a seed is searched so that
+/// uid.hash(seed + 1) puts all its runners on places that are still free (hash and displace). A lookup is then one hash for the
+/// bucket, one for the place and one compare, whatever the amount of runners.
+/// Construct it as a constexpr from a constexpr list and check ok() with a static_assert, it is false when two runners have
+/// the same card or no seed was found.
+template< size_t N >
+class perfectRegistry {
+public:
+    static constexpr size_t places = powerOfTwo(N + N / 4);
+    static constexpr size_t buckets = (N + 3) / 4;
+private:
+    runner table[places] = {};
+    bool used[places] = {};
+    uint16_t seeds[buckets] = {};
+    bool valid = true;
+
+    static constexpr size_t bucketOf(const cardUID & uid){ return uid.hash(0) % buckets; }
+
+    static constexpr size_t placeOf(const cardUID & uid, uint16_t seed){ return uid.hash(uint32_t(seed) + 1) & (places - 1); }
+
+    //members is the list of runners in this bucket
+    constexpr bool placeBucket(const runner (&list)[N], const size_t * members, size_t amount, uint16_t seed){
+        for(size_t i = 0; i < amount; i++){
+            size_t place = placeOf(list[members[i]].uid, seed);
+            if(used[place]){
+                return false;
+            }
+            for(size_t j = 0; j < i; j++){
+                if(placeOf(list[members[j]].uid, seed) == place){
+                    return false;
+                }
+            }
+        }
+        for(size_t i = 0; i < amount; i++){
+            size_t place = placeOf(list[members[i]].uid, seed);
+            table[place] = list[members[i]];
+            used[place] = true;
+        }
+        return true;
+    }
+public:
+    /// @brief Build the registry, meant to run at compile time.
+    constexpr perfectRegistry(const runner (&list)[N]){
+        size_t start[buckets + 1] = {};     //the runners sorted on bucket, bucket b is order[start[b]] to order[start[b + 1]]
+        size_t order[N] = {};
+        for(size_t i = 0; i < N; i++){
+            start[bucketOf(list[i].uid) + 1]++;
+        }
+        size_t biggest = 0;
+        for(size_t b = 0; b < buckets; b++){
+            biggest = start[b + 1] > biggest ? start[b + 1] : biggest;
+            start[b + 1] += start[b];
+        }
+        size_t filled[buckets] = {};
+        for(size_t i = 0; i < N; i++){
+            size_t b = bucketOf(list[i].uid);
+            order[start[b] + filled[b]++] = i;
+        }
+        for(size_t size = biggest; size > 0 && valid; size--){
+            for(size_t b = 0; b < buckets && valid; b++){
+                if(start[b + 1] - start[b] != size){
+                    continue;
+                }
+                uint16_t seed = 0;
+                while(!placeBucket(list, &order[start[b]], size, seed)){
+                    if(seed == 0xFFFF){
+                        valid = false;   //two runners with the same card end up here
+                        break;
+                    }
+                    seed++;
+                }
+                seeds[b] = seed;
+            }
+        }
+    }
+
+    /// @brief False when the registry could not be made.
+    constexpr bool ok() const { return valid; }
+
+    /// @brief The runner of a card, or nullptr when the card is not registered.
+    constexpr const runner * find(const cardUID & uid) const {
+        size_t place = placeOf(uid, seeds[bucketOf(uid)]);
+        if(used[place] && table[place].uid == uid){
+            return &table[place];
+        }
+        return nullptr;
+    }
+
+    /// @brief Amount of runners.
+    static constexpr size_t size(){ return N; }
+};
+
+#endif //RUNNERREGISTRY_HPP
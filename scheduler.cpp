@@ -0,0 +1,47 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "scheduler.hpp"
+
+bool scheduler::add(task & newTask){
+    if(amount >= maxTasks){
+        return false;
+    }
+    tasks[amount++] = &newTask;
+    return true;
+}
+
+void scheduler::step(){
+    for(uint8_t i = 0; i < amount; i++){
+        if(hwlib::now_us() >= tasks[i]->due){
+            uint32_t delay = tasks[i]->run();
+            tasks[i]->due = hwlib::now_us() + delay;    //measured after the run, so a slow task can't make the others run in a burst
+        }
+    }
+}
+
+uint32_t scheduler::idleTime() const{
+    uint_fast64_t now = hwlib::now_us();
+    uint32_t idle = maxIdle;
+    for(uint8_t i = 0; i < amount; i++){
+        if(tasks[i]->due <= now){
+            return 0;
+        }
+        if(tasks[i]->due - now < idle){
+            idle = tasks[i]->due - now;
+        }
+    }
+    return idle;
+}
+
+void scheduler::run(){
+    for(;;){
+        step();
+        uint32_t idle = idleTime();
+        if(idle > 0){
+            hwlib::wait_us(idle);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include "hwlib.hpp"
+
+/// @file
+
+/// @brief
+/// Task for the cooperative scheduler
+/// @detail
+/// run() is called when the task is due. It must return quickly and tells in how many microseconds it wants to run again.
+/// Set due to 0 to make the task run at the next step, for instance when it got new work.
+class task {
+public:
+    /// @brief Time in microseconds (hwlib::now_us) at which the task runs next.
+    uint_fast64_t due = 0;
+
+    /// @brief Do a small piece of work, returns the microseconds until the next run.
+    virtual uint32_t run() = 0;
+};
+
+/// @brief
+/// Cooperative scheduler
+/// @detail
+/// Runs every task that is due, in the order they were added. Nothing is preempted, so a task that waits keeps all the others waiting.
+/// Use it instead of hwlib::wait_ms, so beeping, buttons and serial output go on while a card is handled.
+class scheduler {
+private:
+    const static uint8_t maxTasks = 8;
+    task * tasks[maxTasks];
+    uint8_t amount = 0;
+public:
+    /// @brief Longest wait in µs between two steps, so a task that is made due from outside (due = 0) waits at most this long.
+    const static uint32_t maxIdle = 100000;
+
+    /// @brief Add a task, returns false when there are already maxTasks tasks.
+    bool add(task & newTask);
+
+    /// @brief Run every task that is due once.
+    void step();
+
+    /// @brief µs until the first task is due, at most maxIdle.
+    uint32_t idleTime() const;
+
+    /// @brief Keep running the tasks, never returns.
+    /// @detail
+    /// Between the steps it waits for the first task that is due in one hwlib::wait_us, instead of checking every task again
+    /// and again. On the Due that wait is still busy: hwlib's clock is the SysTick counter, which has to be read at least
+    /// every 200 ms and gives no interrupt to wake a WFI. The pauses of pollSchedule save the current of the readers.
+    void run();
+};
+
+#endif //SCHEDULER_HPP
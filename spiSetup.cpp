@@ -41,6 +41,19 @@ void spiSetup::getBytesFromRegister(const uint8_t regAddress, uint8_t data[], ui
 	}
 }
 
+void spiSetup::getBytesFromRegisters(const uint8_t regAddresses[], uint8_t data[], uint8_t amountOfBytes, hwlib::pin_out& slaveSel) {  //function to
+	const uint16_t arraySize = amountOfBytes + 1;       //read one byte from several registers in one transaction
+	uint8_t write[arraySize] = {0};
+    for(uint8_t i = 0; i < amountOfBytes; i++){
+        write[i] = getReadByte(regAddresses[i]);
+    }
+	uint8_t read[arraySize] = {0};
+	transaction(slaveSel).write_and_read(arraySize, write, read);
+	for(uint8_t i = 0; i < amountOfBytes; i++) {
+		data[i] = read[i + 1];
+	}
+}
+
 void spiSetup::writeByteInRegister(const uint8_t regAddress, uint8_t writeByte, hwlib::pin_out& slaveSel) { //function to write one byte to a register
 	uint8_t write[2] = {getWriteByte(regAddress), writeByte};
 	transaction(slaveSel).write_and_read(2, write, nullptr);
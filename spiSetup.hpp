@@ -23,12 +23,12 @@ private:
     /// @brief Read Mask
     /// @detail
     /// This mask is to read out of a register. 
-	const uint8_t READ_MASK = 0x80; // 1000 0000    mask to get right value of the register byte to read it
+	const static uint8_t READ_MASK = 0x80; // 1000 0000    mask to get right value of the register byte to read it
 
     /// @brief Write Mask
     /// @detail
     /// This mask is to write to a register.
-    const uint8_t WRITE_MASK = 0x7E; // 0111 1110   mask to get right value of the register byte to write to 
+    const static uint8_t WRITE_MASK = 0x7E; // 0111 1110   mask to get right value of the register byte to write to 
 
     /// @brief Get the read byte.
     /// @detail
@@ -68,6 +68,16 @@ public:
     /// @param The chip you want to communicate with.
     void getBytesFromRegister(const uint8_t regAddress, uint8_t data[], uint8_t amountOfBytes, hwlib::pin_out& slaveSel);
 
+    /// @brief Get bytes from several registers.
+    /// @detail
+    /// Reads one byte from every register in regAddresses, all in one transaction.
+    /// The chip answers every address with the byte of the address sent before it, so this costs one byte per register.
+    /// @param regAddresses The addresses you want to read.
+    /// @param data The array where the bytes are stored in, in the order of regAddresses.
+    /// @param amountOfBytes The amount of registers.
+    /// @param slaveSel The chip you want to communicate with.
+    void getBytesFromRegisters(const uint8_t regAddresses[], uint8_t data[], uint8_t amountOfBytes, hwlib::pin_out& slaveSel);
+
     /// @brief Write byte into register.
     /// @detail
     /// This method will write one single byte in to a register.
@@ -86,4 +96,7 @@ public:
     void writeBytesinRegister(const uint8_t regAddress, uint8_t writeBytes[], int amountOfBytes, hwlib::pin_out& slaveSel);
 };
 
+//the masks are constants in flash, the bus is only the bit banged bus of hwlib
+static_assert(sizeof(spiSetup) == sizeof(hwlib::spi_bus_bit_banged_sclk_mosi_miso), "spiSetup may not keep the masks in RAM");
+
 #endif //SPISETUP_HPP
\ No newline at end of file
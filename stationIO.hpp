@@ -0,0 +1,229 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STATIONIO_HPP
+#define STATIONIO_HPP
+
+#include "hwlib.hpp"
+#include "scheduler.hpp"
+#include "ringBuffer.hpp"
+#include "readoutFrame.hpp"
+#include "stationLog.hpp"
+#include "stationTrace.hpp"
+
+/// @file
+
+/// @brief
+/// Beeper that plays patterns in the background
+/// @detail
+/// A pattern is a list of durations in ms, alternating on and off and ending with 0.
+/// play() returns at once, the beeper task switches the pin at the right moments.
+class beeper : public task {
+private:
+    hwlib::pin_out & pin;
+    const uint16_t * pattern = nullptr;
+    uint8_t position = 0;
+    uint8_t again = 0;
+public:
+    /// @brief One beep of 500 ms, the card is written.
+    static constexpr uint16_t good[] = {500, 0};
+    /// @brief Three short beeps and a long one, the start.
+    static constexpr uint16_t start[] = {500, 500, 500, 500, 500, 500, 1000, 0};
+    /// @brief Two short beeps, something went wrong.
+    static constexpr uint16_t error[] = {100, 100, 100, 0};
+
+    /// @brief Constructor
+    /// @param pin The pin of the beeper, high is on.
+    beeper(hwlib::pin_out & pin):
+        pin( pin )
+        {}
+
+    /// @brief Play a pattern, a pattern that is still playing is stopped.
+    /// @detail
+    /// The same pattern while it plays is played once more after it, so two cards on two readers right after each other
+    /// give two beeps.
+    void play(const uint16_t newPattern[]){
+        if(newPattern == pattern){
+            again++;
+            return;
+        }
+        again = 0;
+        pattern = newPattern;
+        position = 0;
+        due = 0;
+    }
+
+    /// @brief Is a pattern playing.
+    bool busy() const { return pattern != nullptr; }
+
+    uint32_t run() override {
+        if(pattern != nullptr && pattern[position] == 0 && again > 0){
+            again--;
+            position = 0;
+            pin.write(0);
+            pin.flush();
+            return 100000;  //a pause between the two, so both can be heard
+        }
+        if(pattern == nullptr || pattern[position] == 0){
+            pin.write(0);
+            pin.flush();
+            pattern = nullptr;
+            return 100000;  //nothing to do, play() wakes the task up
+        }
+        pin.write(position % 2 == 0);
+        pin.flush();
+        return uint32_t(pattern[position++]) * 1000;
+    }
+};
+
+/// @brief
+/// Debounced button
+/// @detail
+/// Samples the pin every 20 ms. A press is only seen after two equal samples, and is remembered until pressed() is called.
+class button : public task {
+private:
+    hwlib::pin_in & pin;
+    bool lastSample = false;
+    bool down = false;
+    bool pressEvent = false;
+public:
+    /// @brief Constructor
+    /// @param pin The pin of the button, high is pressed.
+    button(hwlib::pin_in & pin):
+        pin( pin )
+        {}
+
+    /// @brief Was the button pressed since the last call.
+    bool pressed(){
+        bool event = pressEvent;
+        pressEvent = false;
+        return event;
+    }
+
+    /// @brief Is the button down right now.
+    bool isDown() const { return down; }
+
+    uint32_t run() override {
+        pin.refresh();
+        bool sample = pin.read();
+        if(sample == lastSample && sample != down){
+            down = sample;
+            if(down){
+                pressEvent = true;
+            }
+        }
+        lastSample = sample;
+        return 20000;
+    }
+};
+
+/// @brief
+/// Serial output that never waits
+/// @detail
+/// Everything written to this ostream goes into a buffer, the task sends a few characters every run through hwlib::cout.
+/// When the buffer is full characters are dropped and counted, a punch never waits for the serial line.
+/// Binary readout frames go through the same buffer, so they never get mixed with text.
+class serialOut : public hwlib::ostream, public byteSink, public task {
+private:
+    ringBuffer< char, 4096 > buffer;
+    const static uint8_t charsPerRun = 8;   ///< About 0.7 ms at 115200 baud.
+public:
+    /// @brief Characters that did not fit in the buffer.
+    uint16_t dropped = 0;
+
+    void putc(char c) override {
+        if(!buffer.push(c)){
+            dropped++;
+        }
+        due = 0;
+    }
+
+    void put(uint8_t byte) override {
+        putc(char(byte));
+    }
+
+    void flush() override {}
+
+    /// @brief Free places in the buffer, a frame that does not fit completely is useless.
+    size_t space() const { return buffer.space(); }
+
+    uint32_t run() override {
+        char c;
+        for(uint8_t i = 0; i < charsPerRun && buffer.pop(c); i++){
+            hwlib::cout << c;
+        }
+        return buffer.empty() ? 100000 : 0;
+    }
+};
+
+//the buffer is the serial output, the rest is the bases and the drop counter
+static_assert(sizeof(serialOut) <= sizeof(ringBuffer< char, 4096 >) + 64, "serialOut may only hold its buffer");
+
+/// @brief
+/// Sends the messages of stationLog
+/// @detail
+/// Every message becomes a log frame in the serial output, but only when the whole frame fits,
+/// so the drivers can log in the middle of a card exchange and the text is made on the pc.
+class logOut : public task {
+private:
+    serialOut & out;
+public:
+    /// @brief Constructor
+    /// @param out The serial output the frames go to.
+    logOut(serialOut & out):
+        out( out )
+        {}
+
+    uint32_t run() override {
+        uint8_t message[stationLog::maxSize];
+        while(out.space() >= readoutFrame::frameSize(stationLog::maxSize) && !stationLog::empty()){
+            uint8_t size = stationLog::next(message);
+            frameWriter frame(out);
+            frame.begin(readoutFrame::logType, cardUID(), size);
+            for(uint8_t i = 0; i < size; i++){
+                frame.add(message[i]);
+            }
+            frame.end();
+        }
+        return 100000;  //messages wait at most 100 ms
+    }
+};
+
+#ifdef STATION_TRACE
+/// @brief
+/// Sends the span events of stationTrace
+/// @detail
+/// Up to eventsPerFrame events go in one trace frame, only when the whole frame fits in the serial output.
+class traceOut : public task {
+private:
+    serialOut & out;
+    const static uint8_t eventsPerFrame = 32;
+public:
+    /// @brief Constructor
+    /// @param out The serial output the frames go to.
+    traceOut(serialOut & out):
+        out( out )
+        {}
+
+    uint32_t run() override {
+        while(out.space() >= readoutFrame::frameSize(4 + eventsPerFrame * stationTrace::eventSize) && stationTrace::available() > 0){
+            uint8_t count = stationTrace::available() < eventsPerFrame ? stationTrace::available() : eventsPerFrame;
+            frameWriter frame(out);
+            frame.begin(readoutFrame::traceType, cardUID(), 4 + count * stationTrace::eventSize);
+            frame.add32(stationTrace::rate());
+            uint8_t span;
+            uint32_t time;
+            for(uint8_t i = 0; i < count && stationTrace::next(span, time); i++){
+                frame.add(span);
+                frame.add32(time);
+            }
+            frame.end();
+        }
+        return 100000;
+    }
+};
+#endif
+
+#endif //STATIONIO_HPP
@@ -0,0 +1,41 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "hwlib.hpp"
+#include "stationLog.hpp"
+
+ringBuffer< uint8_t, 256 > stationLog::buffer;
+uint16_t stationLog::dropped = 0;
+
+void stationLog::record(uint8_t id, const uint32_t values[], uint8_t count){
+    if(buffer.space() < size_t(6 + 4 * count)){     //a message goes in completely or not at all
+        dropped++;
+        return;
+    }
+    uint32_t time = hwlib::now_us();
+    buffer.push(id);
+    buffer.push(count);
+    for(uint8_t i = 0; i < 4; i++){
+        buffer.push(uint8_t(time >> (8 * i)));
+    }
+    for(uint8_t value = 0; value < count; value++){
+        for(uint8_t i = 0; i < 4; i++){
+            buffer.push(uint8_t(values[value] >> (8 * i)));
+        }
+    }
+}
+
+uint8_t stationLog::next(uint8_t message[maxSize]){
+    if(buffer.size() < 6){
+        return 0;
+    }
+    buffer.pop(message[0]);
+    buffer.pop(message[1]);
+    uint8_t size = 6 + 4 * message[1];
+    for(uint8_t i = 2; i < size; i++){
+        buffer.pop(message[i]);
+    }
+    return size;
+}
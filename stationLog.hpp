@@ -0,0 +1,119 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STATIONLOG_HPP
+#define STATIONLOG_HPP
+
+#include <cstdint>
+#include "ringBuffer.hpp"
+
+/// @file
+
+#define STATION_LOG_NONE    0
+#define STATION_LOG_ERROR   1
+#define STATION_LOG_WARN    2
+#define STATION_LOG_INFO    3
+#define STATION_LOG_DEBUG   4
+
+/// Messages above this level are removed by the compiler, their arguments are not even evaluated.
+/// Build with -DSTATION_LOG_LEVEL=STATION_LOG_DEBUG to see everything, or STATION_LOG_NONE for nothing at all.
+#ifndef STATION_LOG_LEVEL
+#define STATION_LOG_LEVEL STATION_LOG_WARN
+#endif
+
+/// Every message: name, format ID and the text. Only the ID goes over the serial line, the pc has the text.
+#define STATION_LOG_MESSAGES(X) \
+    X(selectCRCFailed,  1,  "selectCard: CRCerr %u") \
+    X(selectFailed,     2,  "selectCard: NOT OK %02X") \
+    X(noSAK,            3,  "selectCard: No SAK response, %02X") \
+    X(selectCRCWrong,   4,  "selectCard: CRC is wrong") \
+    X(selected,         5,  "selectCard: UID %08X, SAK %02X") \
+    X(notAuthenticated, 6,  "authenticateCard: block %u not authenticated, status %u") \
+    X(authenticated,    7,  "authenticateCard: block %u authenticated") \
+    X(selfTestPassed,   8,  "selfTest: test for firmware version %02X passed") \
+    X(selfTestFailed,   9,  "selfTest: test for firmware version %02X did not pass") \
+    X(noVersion,        10, "selfTest: no version detected (%02X), is the MFRC522 connected correctly?") \
+    X(oscillatorOn,     11, "DS1307: oscilator staat al aan") \
+    X(oscillatorOff,    12, "DS1307: oscilator staat al uit") \
+    X(unknownRate,      13, "DS1307: onbekende modus %u") \
+    X(answerTooLong,    14, "communicate: answer of %u bytes, room for %u") \
+    X(exchangeFailed,   15, "cardStorage: exchange given up, failure class %u after %u recoveries") \
+    X(exchangeSaved,    16, "cardStorage: exchange saved after %u recoveries") \
+    X(journalDropped,   17, "journal: punch frame dropped, serial output full, %u dropped")
+
+#if STATION_LOG_LEVEL >= STATION_LOG_ERROR
+#define LOG_ERROR(...)  stationLog::write(__VA_ARGS__)
+#else
+#define LOG_ERROR(...)  do {} while(0)
+#endif
+
+#if STATION_LOG_LEVEL >= STATION_LOG_WARN
+#define LOG_WARN(...)   stationLog::write(__VA_ARGS__)
+#else
+#define LOG_WARN(...)   do {} while(0)
+#endif
+
+#if STATION_LOG_LEVEL >= STATION_LOG_INFO
+#define LOG_INFO(...)   stationLog::write(__VA_ARGS__)
+#else
+#define LOG_INFO(...)   do {} while(0)
+#endif
+
+#if STATION_LOG_LEVEL >= STATION_LOG_DEBUG
+#define LOG_DEBUG(...)  stationLog::write(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...)  do {} while(0)
+#endif
+
+/// @brief
+/// Deferred binary log
+/// @detail
+/// A message is stored as its format ID, the time and up to four numbers, nothing is formatted on the station.
+/// Writing a message only copies a few bytes into a buffer, so it can be done in the middle of a card exchange.
+/// A task sends the messages later as frames (see readoutFrame::logType) and readoutDecode turns them into text.
+/// When the buffer is full a message is dropped and counted, it never waits.
+///
+/// A message in the buffer and in the payload of the frame:
+/// | bytes | content |
+/// |-------|---------|
+/// | 1     | format ID |
+/// | 1     | amount of numbers |
+/// | 4     | hwlib::now_us() when it was written, little endian |
+/// | 4 * n | the numbers, little endian |
+class stationLog {
+private:
+    static ringBuffer< uint8_t, 256 > buffer;
+
+    static void record(uint8_t id, const uint32_t values[], uint8_t count);
+public:
+#define STATION_LOG_ID(name, id, text) const static uint8_t name = id;
+    STATION_LOG_MESSAGES(STATION_LOG_ID)
+#undef STATION_LOG_ID
+
+    const static uint8_t maxValues = 4;                             /// @brief Numbers in one message.
+    const static uint8_t maxSize = 1 + 1 + 4 + 4 * maxValues;       /// @brief Bytes of the largest message.
+    const static uint32_t staticSize = sizeof(buffer);              /// @brief Static RAM of the message buffer, see the budget in main.cpp.
+
+    /// @brief Messages that did not fit in the buffer.
+    static uint16_t dropped;
+
+    /// @brief Store a message, use the LOG_ macros so it is removed when its level is off.
+    template< typename... T >
+    static void write(uint8_t id, T... values){
+        static_assert(sizeof...(T) <= maxValues, "a log message has at most 4 numbers");
+        const uint32_t list[] = {uint32_t(values)..., 0};
+        record(id, list, sizeof...(T));
+    }
+
+    /// @brief Take the oldest message out of the buffer.
+    /// @param message maxSize bytes for the message.
+    /// @return The size of the message, 0 when there is none.
+    static uint8_t next(uint8_t message[maxSize]);
+
+    /// @brief Are there messages waiting.
+    static bool empty(){ return buffer.empty(); }
+};
+
+#endif //STATIONLOG_HPP
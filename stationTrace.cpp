@@ -0,0 +1,82 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#include "stationTrace.hpp"
+
+#ifdef STATION_TRACE
+
+#ifdef __SAM3X8E__
+#include "hwlib.hpp"
+
+//the cycle counter of hwlib, 84 MHz on the Due
+class cycleClock : public tickSource {
+public:
+    uint32_t ticks() override { return uint32_t(hwlib::now_ticks()); }
+    uint32_t rate() const override { return uint32_t(hwlib::ticks_per_us() * 1000000); }
+};
+#else
+#include <chrono>
+
+//the drivers on Linux, without hwlib
+class cycleClock : public tickSource {
+public:
+    uint32_t ticks() override {
+        return uint32_t(std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    uint32_t rate() const override { return 1000000000; }
+};
+#endif
+
+static cycleClock defaultClock;
+
+uint32_t stationTrace::times[capacity];
+uint8_t stationTrace::spans[capacity];
+uint16_t stationTrace::head = 0;
+uint16_t stationTrace::committed = 0;
+uint16_t stationTrace::tail = 0;
+bool stationTrace::overflow = false;
+tickSource * stationTrace::clock = &defaultClock;
+uint16_t stationTrace::dropped = 0;
+
+void stationTrace::useClock(tickSource & source){
+    clock = &source;
+    head = committed = tail = 0;
+    overflow = false;
+}
+
+void stationTrace::record(uint8_t span){
+    uint16_t next = (head + 1) % capacity;
+    if(next == tail){
+        overflow = true;
+        return;
+    }
+    times[head] = clock->ticks();
+    spans[head] = span;
+    head = next;
+}
+
+void stationTrace::commit(bool keep){
+    if(keep && overflow){
+        dropped++;
+    }
+    if(keep && !overflow){
+        committed = head;
+    }else{
+        head = committed;
+    }
+    overflow = false;
+}
+
+bool stationTrace::next(uint8_t & span, uint32_t & time){
+    if(tail == committed){
+        return false;
+    }
+    span = spans[tail];
+    time = times[tail];
+    tail = (tail + 1) % capacity;
+    return true;
+}
+
+#endif //STATION_TRACE
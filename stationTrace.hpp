@@ -0,0 +1,115 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STATIONTRACE_HPP
+#define STATIONTRACE_HPP
+
+#include <cstdint>
+#include "tickSource.hpp"
+
+/// @file
+
+/// Every span: name, ID and the name on the pc. Only the ID and the time go over the serial line.
+#define STATION_TRACE_SPANS(X) \
+    X(loop,          1,  "loop") \
+    X(detect,        2,  "detect") \
+    X(anticollision, 3,  "anticollision") \
+    X(select,        4,  "select") \
+    X(authenticate,  5,  "authenticate") \
+    X(read,          6,  "read") \
+    X(rtcRead,       7,  "rtc read") \
+    X(encode,        8,  "encode") \
+    X(write,         9,  "write") \
+    X(feedback,      10, "feedback") \
+    X(communicate,   11, "communicate") \
+    X(calculateCRC,  12, "calculateCRC")
+
+/// Tracing is only compiled in with -DSTATION_TRACE, otherwise the macros are empty and stationTrace uses no RAM.
+#ifdef STATION_TRACE
+#define TRACE_BEGIN(span)   stationTrace::begin(stationTrace::span)
+#define TRACE_END(span)     stationTrace::end(stationTrace::span)
+#define TRACE_SPAN(span)    traceSpan traceSpan_##span(stationTrace::span)
+#define TRACE_COMMIT(keep)  stationTrace::commit(keep)
+#else
+#define TRACE_BEGIN(span)   do {} while(0)
+#define TRACE_END(span)     do {} while(0)
+#define TRACE_SPAN(span)    do {} while(0)
+#define TRACE_COMMIT(keep)  do {} while(0)
+#endif
+
+/// @brief
+/// Spans of the punch path
+/// @detail
+/// A span is a begin and an end event, each with the span ID and the time from a tickSource. The default clock is
+/// hwlib::now_ticks(), the cycle counter of the Due, or std::chrono::steady_clock when the drivers run on Linux without hwlib.
+///
+/// Events are only sent for a loop of the station task that did something: the loop calls TRACE_COMMIT(true) to keep
+/// the events since the previous commit and TRACE_COMMIT(false) to throw them away, so the buffer is not filled with
+/// searches that found no card. A loop that does not fit completely is dropped and counted.
+/// The traceOut task sends the events as trace frames (see readoutFrame::traceType), traceExport on the pc makes a
+/// summary, a timeline and a flame graph out of them.
+class stationTrace {
+private:
+    const static uint16_t capacity = 256;
+    static uint32_t times[capacity];
+    static uint8_t spans[capacity];
+    static uint16_t head, committed, tail;
+    static bool overflow;
+    static tickSource * clock;
+
+    static void record(uint8_t span);
+public:
+#define STATION_TRACE_ID(name, id, text) const static uint8_t name = id;
+    STATION_TRACE_SPANS(STATION_TRACE_ID)
+#undef STATION_TRACE_ID
+
+    const static uint8_t endFlag = 0x80;        /// @brief Set in the ID of an end event.
+    const static uint8_t eventSize = 5;         /// @brief ID and time (4 bytes) of an event in a frame.
+    const static uint32_t staticSize = sizeof(times) + sizeof(spans);  /// @brief Static RAM of the event buffer, see the budget in main.cpp.
+
+    /// @brief Loops that did not fit in the buffer.
+    static uint16_t dropped;
+
+    /// @brief Use another clock for the events, the events already in the buffer are thrown away.
+    static void useClock(tickSource & source);
+
+    /// @brief Ticks per second of the clock.
+    static uint32_t rate(){ return clock->rate(); }
+
+    /// @brief Start of a span, use TRACE_BEGIN or TRACE_SPAN.
+    static void begin(uint8_t span){ record(span); }
+
+    /// @brief End of a span, use TRACE_END.
+    static void end(uint8_t span){ record(span | endFlag); }
+
+    /// @brief Keep or throw away the events since the last commit, use TRACE_COMMIT.
+    static void commit(bool keep);
+
+    /// @brief Take the oldest kept event out of the buffer.
+    /// @return false when there is none.
+    static bool next(uint8_t & span, uint32_t & time);
+
+    /// @brief Amount of kept events.
+    static uint16_t available(){ return (committed + capacity - tail) % capacity; }
+};
+
+/// @brief
+/// A span of the scope it is declared in, the end is recorded at every return.
+class traceSpan {
+private:
+    uint8_t span;
+public:
+    traceSpan(uint8_t span):
+        span( span )
+    {
+        stationTrace::begin(span);
+    }
+
+    ~traceSpan(){
+        stationTrace::end(span);
+    }
+};
+
+#endif //STATIONTRACE_HPP
@@ -0,0 +1,27 @@
+//Copyright David Hulsebosch 2022.
+// Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TICKSOURCE_HPP
+#define TICKSOURCE_HPP
+
+#include <cstdint>
+
+/// @file
+
+/// @brief
+/// Free running tick counter
+/// @detail
+/// Interface for a counter that counts at a fixed rate, like the edges of the 32.768 kHz SQW/OUT output of the DS1307.
+/// The counter is allowed to wrap around after 2^32 ticks.
+class tickSource {
+public:
+    /// @brief Current value of the counter.
+    virtual uint32_t ticks() = 0;
+
+    /// @brief Ticks per second.
+    virtual uint32_t rate() const = 0;
+};
+
+#endif //TICKSOURCE_HPP